@@ -14,7 +14,7 @@ namespace slisc
 	{
 		// Algorithm from Numerical Recipes 3ed
 		// empty construcotr uses "std:time()" as seed, avoid calling it twice in the same second.
-		// it is best if the whole program uses only one object, which is currently in rand() function.
+		// it is best if each thread uses only one object, which is currently in rand() function.
 		class Ran
 		{
 		private:
@@ -38,11 +38,26 @@ namespace slisc
 		};
 	}
 
+	namespace internal
+	{
+		// generator of the current thread
+		inline Ran & rand_gen()
+		{
+			static thread_local Ran gen;
+			return gen;
+		}
+	}
+
 	// generate random Doub in [0, 1]
 	inline Doub rand()
 	{
-		static internal::Ran rand_gen;
-		return rand_gen.doub();
+		return internal::rand_gen().doub();
+	}
+
+	// restart the generator of the current thread with a seed, for reproducible runs
+	inline void rand_seed(Ullong_I seed)
+	{
+		internal::rand_gen() = internal::Ran(seed);
 	}
 
 	// generate random Int in {0,1,2,...,N-1}
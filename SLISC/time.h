@@ -4,6 +4,13 @@
 #include "slisc.h"
 #include <chrono>
 #include <ctime>
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define SLS_HAS_RDTSC
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define SLS_HAS_RDTSC
+#endif
 
 namespace slisc {
 
@@ -36,6 +43,31 @@ public:
 	{ return (clock() - start) / (Doub)CLOCKS_PER_SEC; }
 };
 
+// cheap time stamp for short intervals: cpu time stamp counter (rdtsc) if available, or steady_clock in ns
+// not serialized, only meaningful when summed over many intervals
+inline Ullong ticks()
+{
+#ifdef SLS_HAS_RDTSC
+	return __rdtsc();
+#else
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// seconds per tick, measured once against steady_clock (takes 20ms)
+inline Doub tick_sec()
+{
+	static const Doub sec = [] {
+		Timer timer; timer.tic();
+		Ullong t0 = ticks();
+		Doub t;
+		while ((t = timer.toc()) < 0.02);
+		return t / (ticks() - t0);
+	}();
+	return sec;
+}
+
 inline void pause() // pause untill key press
 { printf("\nPress return to continue.\n"); getchar(); }
 
@@ -0,0 +1,198 @@
+#pragma once
+#include "tree.h"
+#include <cstring>
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#ifdef _MSC_VER
+#include <io.h>
+#define access _access
+#define F_OK 0
+#define W_OK 2
+#else
+#include <unistd.h>
+#endif
+
+// solve without prompts, used by "go [options]" (see main.cpp)
+// exit codes: 0 solved, 1 illegal input, 2 error of the solver, 130 interrupted (SIGINT with --checkpoint)
+
+// check that a file can be written, without creating or truncating it
+inline Bool writable(const string &name)
+{
+	if (access(name.c_str(), F_OK) == 0)
+		return access(name.c_str(), W_OK) == 0;
+	// a new file, the directory must be writable
+	size_t i = name.find_last_of("/\\");
+	string dir = i == string::npos ? "." : name.substr(0, i + 1);
+	return access(dir.c_str(), W_OK) == 0;
+}
+
+// parse a whole argument as a number
+// return false if it's not a number or out of range
+inline Bool parse_num(Int_O val, const char *str)
+{
+	char *end;
+	errno = 0;
+	long v = strtol(str, &end, 10);
+	if (end == str || *end || errno || v < INT_MIN || v > INT_MAX)
+		return false;
+	val = v;
+	return true;
+}
+
+inline Bool parse_num(Doub_O val, const char *str)
+{
+	char *end;
+	errno = 0;
+	Doub v = strtod(str, &end);
+	if (end == str || *end || errno || !std::isfinite(v))
+		return false;
+	val = v;
+	return true;
+}
+
+// solve without prompts
+// on illegal input, print to stderr and return 1
+// error() of the solver throws (error_throw()), it's printed to stderr and 2 is returned
+inline int batch_solve(int argc, char *argv[])
+{
+	Int i, Nx = 3, Ny = 3, komi = 17, log = 1;
+	Doub k = 8.5, interval = 1, ckpt_interval = 600;
+	string moves, out = "test.sgf", progress, ckpt, restore;
+
+	for (i = 1; i < argc; ++i) {
+		const char *opt = argv[i];
+		Bool has1 = i + 1 < argc, ok = true;
+		if (strcmp(argv[i], "--size") == 0 && i + 2 < argc) {
+			ok = parse_num(Nx, argv[i + 1]) && parse_num(Ny, argv[i + 2]); i += 2;
+		}
+		else if (strcmp(argv[i], "--komi") == 0 && has1) {
+			// integer or half integer
+			ok = parse_num(k, argv[++i]) && std::abs(k) < 1e6 && 2 * k == std::round(2 * k);
+			komi = std::round(2 * k);
+		}
+		else if (strcmp(argv[i], "--moves") == 0 && has1)
+			moves = argv[++i];
+		else if (strcmp(argv[i], "--out") == 0 && has1)
+			out = argv[++i];
+		else if (strcmp(argv[i], "--log") == 0 && has1)
+			ok = parse_num(log, argv[++i]);
+		else if (strcmp(argv[i], "--progress") == 0 && has1)
+			progress = argv[++i];
+		else if (strcmp(argv[i], "--interval") == 0 && has1)
+			ok = parse_num(interval, argv[++i]) && interval > 0;
+		else if (strcmp(argv[i], "--checkpoint") == 0 && has1)
+			ckpt = argv[++i];
+		else if (strcmp(argv[i], "--checkpoint-interval") == 0 && has1)
+			ok = parse_num(ckpt_interval, argv[++i]) && ckpt_interval > 0;
+		else if (strcmp(argv[i], "--restore") == 0 && has1)
+			restore = argv[++i];
+		else {
+			cerr << "unknown option or missing value: " << argv[i] << endl;
+			return 1;
+		}
+		if (!ok) {
+			cerr << "illegal value of " << opt << "!" << endl;
+			return 1;
+		}
+	}
+	if (log < 0 || log > 2) {
+		cerr << "--log must be 0, 1 or 2!" << endl;
+		return 1;
+	}
+
+	if (!restore.empty()) {
+		CkptHeader header;
+		const char *msg = checkpoint_header(header, restore);
+		if (msg) {
+			cerr << restore << ": " << msg << endl;
+			return 1;
+		}
+		Nx = header.m_Nx; Ny = header.m_Ny; komi = header.m_komi2;
+	}
+	// a board is one 64 bit word
+	if (Nx < 1 || Ny < 1 || Nx * Ny > 64) {
+		cerr << "illegal board size " << Nx << "x" << Ny << ", need Nx, Ny >= 1 and Nx*Ny <= 64!" << endl;
+		return 1;
+	}
+	if (abs(komi) > 2 * Nx * Ny) {
+		cerr << "komi too large or too small, one side always wins!" << endl;
+		return 1;
+	}
+	if (!writable(out) || (!ckpt.empty() && !writable(ckpt + ".tmp"))) {
+		cerr << "can't write the output or checkpoint file!" << endl;
+		return 1;
+	}
+
+	FILE *fprog = stderr;
+	error_throw(1);
+	try {
+		board_Nx(Nx); board_Ny(Ny); komi2(komi);
+		Tree tree;
+		tree.set_interactive(false);
+		if (!restore.empty()) {
+			CkptHeader header;
+			checkpoint_header(header, restore);
+			const char *msg = Tree::restore_invalid(header);
+			if (msg) {
+				cerr << restore << ": " << msg << endl;
+				return 1;
+			}
+			slisc::Timer timer; timer.tic();
+			tree.restore(restore);
+			cout << "restored " << tree.nnode() << " nodes in " << timer.toc() << " s" << endl;
+		}
+		if (!ckpt.empty()) {
+			tree.set_checkpoint(ckpt, ckpt_interval);
+			install_checkpoint_signals();
+		}
+		if (!progress.empty()) {
+			fprog = fopen(progress.c_str(), "w");
+			if (!fprog) {
+				cerr << "failed to open the progress file: " << progress << endl;
+				return 1;
+			}
+		}
+		tree.set_log(Log(log), fprog, interval);
+
+		// start position
+		Long treeInd = 0;
+		for (i = 0; i < (Int)moves.size(); ) {
+			if (moves[i] == ' ') {
+				++i; continue;
+			}
+			Int x = moves[i] - 'a', y = i + 1 < (Int)moves.size() ? moves[i + 1] - 'a' : -1;
+			if (x < 0 || x >= Nx || y < 0 || y >= Ny || (treeInd = tree.child(treeInd, Move(x, y))) < 0) {
+				cerr << "illegal start position at move " << moves.substr(i, 2) << "!" << endl;
+				if (fprog != stderr)
+					fclose(fprog);
+				return 1;
+			}
+			i += 2;
+		}
+
+		slisc::Timer timer; timer.tic();
+		tree.solve(treeInd);
+		Doub time = timer.toc();
+		if (!ckpt.empty())
+			tree.checkpoint(ckpt);
+		tree.writeSGF(out);
+
+		// result for black
+		Int black_sco2 = tree.who(treeInd) == Who::BLACK ? tree.score2(treeInd) : inv_score2(tree.score2(treeInd));
+		cout << "solution: " << Int(tree.solution(treeInd)) << ", black score: " << 0.5 * black_sco2
+			<< ", nodes: " << tree.nnode() << ", time: " << time << " s" << endl;
+	}
+	catch (const ErrorGo &e) {
+		cerr << "error: " << e.what() << endl;
+		if (fprog != stderr)
+			fclose(fprog);
+		return 2;
+	}
+	if (fprog != stderr)
+		fclose(fprog);
+	// SIGINT after solve() (checkpoint already written)
+	if (checkpoint_signal().load() == 2)
+		return 130;
+	return 0;
+}
@@ -0,0 +1,519 @@
+// solver benchmark
+// runs a fixed matrix of workloads with fixed seeds, and prints the results as JSON
+// board size can only be set once in a process, so each workload runs in a child process (bench --run <index>)
+// usage:
+//   bench          run the default workloads
+//   bench --full   also run the unverified large boards (4x4)
+//   bench --run i  run the i-th workload only
+//   bench --perft Nx Ny depth  count move sequences of the rule kernels and of GroupTable::place() (see perft.h)
+//   bench --sgf file  replay all lines of an SGF file with Board::place()
+//   bench --search i  solve workload i by mtdf() and solve_komi(), and compare with solve() (unless a ko decides)
+//   bench --reuse i j  solve workload i, then workload j in another Tree sharing the transposition table
+//   bench --split i Nthread  solve workload i by solve() and by solve_split() on Nthread threads, report the speedup
+//   bench --pool Nthread Nconfig  insert the same configs into one Pool from many threads and check the pool indices
+//   bench --batch code name [options]  run "go [options]" (batch_solve()) and check the exit code
+// return 0 if all solutions are verified
+// compile with GOS_PROFILE to add the counters of prof.h to each workload
+
+#include "tree.h"
+#include "perft.h"
+#include "batch.h"
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <random>
+#include <algorithm>
+#ifdef _MSC_VER
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#define popen _popen
+#define pclose _pclose
+#else
+#include <sys/resource.h>
+#endif
+
+// a benchmark workload
+class Workload
+{
+public:
+	const char *name;
+	Int Nx, Ny;
+	Int komi2;
+	const char *moves; // start position, moves in SGF coordinates separated by spaces, "" for empty board
+	Ullong seed;
+	Sol black_sol; // known solution for black, Sol::UNKNOWN if unknown
+	Int black_sco2; // score2 of black found with this seed, -1 if unknown
+	Bool full; // only run with --full
+};
+
+// black takes the whole board on the empty boards below (for 3x3 by playing the center)
+// so black wins at any komi smaller than the board, and a komi only changes the work of the search
+// (the solver does not support a draw yet), so komi is just below the board where it makes the search harder
+// 4x4 is not verified: it has no known result and takes too long to be a default workload
+static const Workload workloads[] = {
+	{ "2x2_k3.5", 2, 2, 7, "", 1, Sol::GOOD, 8, false },
+	{ "2x3_k5.5", 2, 3, 11, "", 2, Sol::GOOD, 12, false },
+	{ "3x2_k5.5", 3, 2, 11, "", 3, Sol::GOOD, 12, false },
+	{ "3x3_k8.5", 3, 3, 17, "", 4, Sol::GOOD, 18, false },
+	{ "3x3_k8.5_bb", 3, 3, 17, "bb", 5, Sol::GOOD, 18, false },
+	{ "3x3_k8.5_bb_bc_cc_cb", 3, 3, 17, "bb bc cc cb", 6, Sol::BAD, 0, false }, // white wins, see solve3x3.sgf
+	{ "3x4_k0.5", 3, 4, 1, "", 7, Sol::GOOD, -1, false }, // the score is not checked, ko scores of solve() depend on the move order on 3x4
+	{ "4x4_k0.5", 4, 4, 1, "", 8, Sol::UNKNOWN, -1, true }, // unverified
+	{ "3x3_k8.5_bb_cb_ac_ca", 3, 3, 17, "bb cb ac ca", 9, Sol::GOOD, 18, false },
+	{ "3x3_k8.5_bb_cb_ca_ba_ac", 3, 3, 17, "bb cb ca ba ac", 10, Sol::BAD, 0, false }, // white wins
+};
+
+static const Int Nworkload = sizeof(workloads) / sizeof(workloads[0]);
+
+// workloads of the default run also solved by mtdf() (2x2, 2x3 and 3x3)
+// mtdf() does not allow a repeated situation (positional super ko), so it disagrees with the ko rules of solve()
+// where a ko decides the game, black_sco2 is the score under super ko ("bb bc cc cb" also found without m_score_table)
+struct SearchWorkload
+{
+	Int ind; // index of workloads[]
+	Int black_sco2; // score2 of black under super ko
+	Bool same_as_solve; // solve() finds the same solution
+};
+
+static const SearchWorkload search_workloads[] = {
+	{ 0, 8, true },
+	{ 1, 12, true },
+	{ 3, 18, true },
+	{ 4, 18, true },
+	{ 5, 18, false }, // black wins by a ko that solve() does not allow to win
+	{ 8, 18, true },
+	{ 9, 0, true },
+};
+
+static const Int Nsearch = sizeof(search_workloads) / sizeof(search_workloads[0]);
+
+// limit of score_search0() calls of each mtdf() and solve_komi() (3x3 from the empty board takes about 5e6)
+static const Long search_max = 20000000;
+
+// peak resident memory of the process in KB
+inline Long peak_rss_kb()
+{
+#ifdef _MSC_VER
+	PROCESS_MEMORY_COUNTERS pmc;
+	GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc));
+	return pmc.PeakWorkingSetSize / 1024;
+#else
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss;
+#endif
+}
+
+// play the moves of a workload from the empty board, return the tree index of the start position
+inline Long start_node(Tree &tree, const char *moves)
+{
+	Long treeInd = 0;
+	for (const char *p = moves; *p; ) {
+		if (*p == ' ') {
+			++p; continue;
+		}
+		treeInd = tree.child(treeInd, Move(p[0] - 'a', p[1] - 'a'));
+		if (treeInd < 0)
+			error("illegal start position!");
+		p += 2;
+	}
+	return treeInd;
+}
+
+// solve a node, output the time and the result for black
+inline void solve_node(Doub_O time, Sol_O black_sol, Int_O black_sco2, Tree &tree, Long_I treeInd)
+{
+	slisc::Timer timer; timer.tic();
+	tree.solve(treeInd);
+	time = timer.toc();
+	Sol sol = tree.solution(treeInd);
+	Bool black_played = tree.who(treeInd) == Who::BLACK;
+	black_sol = black_played ? sol : inv_sol(sol);
+	black_sco2 = black_played ? tree.score2(treeInd) : inv_score2(tree.score2(treeInd));
+}
+
+// run one workload and print a JSON object in one line
+// return 0 if verified (or nothing to verify)
+inline Int run(Int_I ind)
+{
+	const Workload &w = workloads[ind];
+	board_Nx(w.Nx); board_Ny(w.Ny); komi2(w.komi2);
+	slisc::rand_seed(w.seed);
+
+	Tree tree;
+	tree.set_interactive(false);
+	tree.set_log(Log::QUIET);
+	Long treeInd = start_node(tree, w.moves);
+	Doub time;
+	Sol black_sol;
+	Int black_sco2;
+	solve_node(time, black_sol, black_sco2, tree, treeInd);
+	Bool verified = w.black_sol != Sol::UNKNOWN;
+	Bool ok = (!verified || black_sol == w.black_sol) && (w.black_sco2 < 0 || black_sco2 == w.black_sco2);
+
+	printf("{\"name\": \"%s\", \"Nx\": %d, \"Ny\": %d, \"komi2\": %d, \"moves\": \"%s\", \"seed\": %llu, "
+		"\"time\": %.6f, \"nodes\": %lld, \"pool\": %lld, \"links\": %lld, \"peak_rss_kb\": %lld, \"nodes_per_sec\": %.1f, "
+		"\"tt_probes\": %lld, \"tt_hits\": %lld, \"solution\": %d, \"black_solution\": %d, \"expected_black_solution\": %d, "
+		"\"black_score2\": %d, \"expected_black_score2\": %d, \"verified\": %s, \"ok\": %s",
+		w.name, w.Nx, w.Ny, w.komi2, w.moves, w.seed,
+		time, (long long)tree.nnode(), (long long)tree.npool(), (long long)tree.nlink(), (long long)peak_rss_kb(),
+		tree.nnode() / MAX(time, 1e-9), (long long)tree.tt_probes(), (long long)tree.tt_hits(),
+		Int(tree.solution(treeInd)), Int(black_sol), Int(w.black_sol),
+		black_sco2, w.black_sco2, verified ? "true" : "false", ok ? "true" : "false");
+#ifdef GOS_PROFILE
+	printf(", \"profile\": %s", prof_json().c_str());
+#endif
+	printf("}\n");
+	fflush(stdout);
+	return ok ? 0 : 1;
+}
+
+// re-use of the transposition table: solve workload 'ind1', then solve workload 'ind2' in a new Tree sharing the table
+// both workloads must have the same board size and komi, and a known solution
+// the second solution is checked, and solve() must have solved some nodes from the table
+// (its score is not checked, a node solved from the table may only get a bound of the score)
+inline Int run_reuse(Int_I ind1, Int_I ind2)
+{
+	const Workload &w1 = workloads[ind1], &w2 = workloads[ind2];
+	if (w1.Nx != w2.Nx || w1.Ny != w2.Ny || w1.komi2 != w2.komi2)
+		error("workloads of another board size or komi!");
+	if (w2.black_sol == Sol::UNKNOWN)
+		error("workload not verified!");
+	board_Nx(w1.Nx); board_Ny(w1.Ny); komi2(w1.komi2);
+	slisc::rand_seed(w1.seed);
+
+	Tree tree1, tree2;
+	tree1.set_interactive(false); tree2.set_interactive(false);
+	tree1.set_log(Log::QUIET); tree2.set_log(Log::QUIET);
+	Doub time1, time2;
+	Sol black_sol1, black_sol2;
+	Int black_sco2;
+	solve_node(time1, black_sol1, black_sco2, tree1, start_node(tree1, w1.moves));
+
+	tree2.share_trans_table(tree1);
+	slisc::rand_seed(w2.seed);
+	solve_node(time2, black_sol2, black_sco2, tree2, start_node(tree2, w2.moves));
+	Bool ok = black_sol2 == w2.black_sol && tree2.tt_hits() > 0;
+
+	printf("{\"name\": \"reuse\", \"first\": \"%s\", \"second\": \"%s\", "
+		"\"first_time\": %.6f, \"first_nodes\": %lld, \"second_time\": %.6f, \"second_nodes\": %lld, "
+		"\"tt_probes\": %lld, \"tt_hits\": %lld, \"black_solution\": %d, \"expected_black_solution\": %d, \"ok\": %s}\n",
+		w1.name, w2.name, time1, (long long)tree1.nnode(), time2, (long long)tree2.nnode(),
+		(long long)tree2.tt_probes(), (long long)tree2.tt_hits(), Int(black_sol2), Int(w2.black_sol), ok ? "true" : "false");
+	fflush(stdout);
+	return ok ? 0 : 1;
+}
+
+// score search of a workload: mtdf() and solve_komi() in one Tree, compared with solve() in another Tree
+// the two must agree, and with the score under super ko in search_workloads[] (if listed)
+// and with solve() and the known result, unless a ko decides the game
+inline Int run_search(Int_I ind)
+{
+	const Workload &w = workloads[ind];
+	SearchWorkload sw = { ind, w.black_sco2, true };
+	for (Int i = 0; i < Nsearch; ++i)
+		if (search_workloads[i].ind == ind)
+			sw = search_workloads[i];
+	board_Nx(w.Nx); board_Ny(w.Ny); komi2(w.komi2);
+	slisc::rand_seed(w.seed);
+
+	Tree tree, tree_solve;
+	tree.set_interactive(false); tree_solve.set_interactive(false);
+	tree.set_log(Log::QUIET); tree_solve.set_log(Log::QUIET);
+	Long treeInd = start_node(tree, w.moves);
+	Who who = next(tree.who(treeInd)); // to move
+	Bool black_moves = who == Who::BLACK;
+
+	slisc::Timer timer; timer.tic();
+	tree.set_search_max(search_max);
+	Int sco2 = tree.mtdf(treeInd, w.Nx * w.Ny);
+	Doub time_mtdf = timer.toc();
+	Long nnode_mtdf = tree.nnode();
+	timer.tic();
+	tree.set_search_max(search_max);
+	Sol sol = tree.solve_komi(treeInd);
+	Doub time_komi = timer.toc();
+	Int black_sco2 = sco2 < 0 ? sco2 : black_moves ? sco2 : inv_score2(sco2);
+	Sol black_sol = black_moves ? sol : inv_sol(sol);
+
+	Doub time_solve;
+	Sol black_sol_solve;
+	Int black_sco2_solve;
+	slisc::rand_seed(w.seed); // same move order as "bench"
+	solve_node(time_solve, black_sol_solve, black_sco2_solve, tree_solve, start_node(tree_solve, w.moves));
+
+	Bool ok = sco2 >= 0 && sol == sco22sol(sco2, who) && (sw.black_sco2 < 0 || black_sco2 == sw.black_sco2);
+	if (sw.same_as_solve)
+		ok = ok && black_sol == black_sol_solve && (w.black_sol == Sol::UNKNOWN || black_sol == w.black_sol);
+	printf("{\"name\": \"search_%s\", \"mtdf_time\": %.6f, \"mtdf_nodes\": %lld, \"solve_komi_time\": %.6f, "
+		"\"solve_time\": %.6f, \"solve_nodes\": %lld, \"repeated\": %lld, \"ko_dependent\": %s, \"black_score2\": %d, "
+		"\"expected_black_score2\": %d, \"black_solution\": %d, \"solve_black_solution\": %d, \"ok\": %s}\n",
+		w.name, time_mtdf, (long long)nnode_mtdf, time_komi, time_solve, (long long)tree_solve.nnode(),
+		(long long)tree.score_search_repeat(), sw.same_as_solve ? "false" : "true", black_sco2, sw.black_sco2,
+		Int(black_sol), Int(black_sol_solve), ok ? "true" : "false");
+	fflush(stdout);
+	return ok ? 0 : 1;
+}
+
+// solve workload i by solve(), then in another tree by solve_split() on Nthread threads
+// the solutions must agree, the speedup is only reported (it's bounded by the cores of the machine)
+inline Int run_split(Int_I ind, Int_I Nthread)
+{
+	const Workload &w = workloads[ind];
+	board_Nx(w.Nx); board_Ny(w.Ny); komi2(w.komi2);
+	Tree tree1, tree2;
+	tree1.set_interactive(false); tree2.set_interactive(false);
+	tree1.set_log(Log::QUIET); tree2.set_log(Log::QUIET);
+	Doub time1, time2;
+	Sol black_sol1, black_sol2;
+	Int black_sco2;
+	slisc::rand_seed(w.seed);
+	solve_node(time1, black_sol1, black_sco2, tree1, start_node(tree1, w.moves));
+
+	vector<Move> moves;
+	for (const char *p = w.moves; *p; ++p)
+		if (*p != ' ') {
+			moves.push_back(Move(p[0] - 'a', p[1] - 'a')); ++p;
+		}
+	Long treeInd = start_node(tree2, w.moves);
+	slisc::rand_seed(w.seed);
+	slisc::Timer timer; timer.tic();
+	tree2.solve_split(treeInd, moves, Nthread);
+	time2 = timer.toc();
+	Sol sol = tree2.solution(treeInd);
+	black_sol2 = tree2.who(treeInd) == Who::BLACK ? sol : inv_sol(sol);
+	Bool ok = black_sol2 == black_sol1 && (w.black_sol == Sol::UNKNOWN || black_sol2 == w.black_sol);
+
+	printf("{\"name\": \"split_%s\", \"threads\": %d, \"cores\": %u, \"serial_time\": %.6f, \"split_time\": %.6f, "
+		"\"speedup\": %.3f, \"serial_nodes\": %lld, \"split_nodes\": %lld, \"black_solution\": %d, "
+		"\"serial_black_solution\": %d, \"ok\": %s}\n",
+		w.name, Nthread, std::thread::hardware_concurrency(), time1, time2, time1 / MAX(time2, 1e-9),
+		(long long)tree1.nnode(), (long long)tree2.nnode(), Int(black_sol2), Int(black_sol1), ok ? "true" : "false");
+	fflush(stdout);
+	return ok ? 0 : 1;
+}
+
+// perft from the empty board, by the rule kernels and by GroupTable::place(), the leaf counts must agree
+inline Int run_perft(Int_I Nx, Int_I Ny, Int_I depth)
+{
+	board_Nx(Nx); board_Ny(Ny);
+	PerftCount count, count_groups;
+	Config config; config.init();
+	GroupTable groups; groups.build(config);
+	slisc::Timer timer; timer.tic();
+	perft(count, config, Who::BLACK, depth);
+	Doub time = timer.toc();
+	timer.tic();
+	perft_groups(count_groups, groups, Who::BLACK, depth);
+	Doub time_groups = timer.toc();
+	Bool ok = count_groups.leaves == count.leaves && count_groups.positions == count.positions;
+	printf("{\"name\": \"perft\", \"Nx\": %d, \"Ny\": %d, \"depth\": %d, \"time\": %.6f, "
+		"\"leaves\": %lld, \"positions\": %lld, \"positions_per_sec\": %.1f, \"groups_time\": %.6f, "
+		"\"groups_leaves\": %lld, \"groups_positions_per_sec\": %.1f, \"ok\": %s}\n",
+		Nx, Ny, depth, time, (long long)count.leaves, (long long)count.positions, count.positions / MAX(time, 1e-9),
+		time_groups, (long long)count_groups.leaves, count_groups.positions / MAX(time_groups, 1e-9), ok ? "true" : "false");
+	fflush(stdout);
+	return ok ? 0 : 1;
+}
+
+// batch runs of "go" in the default run: exit code, name and options
+static const char *batch_runs[][3] = {
+	{ "0", "3x4", "--size 3 4 --komi 0.5 --log 0 --out bench_batch.sgf" }, // solver errors on 3x4 used to block on error()
+	{ "1", "komi_abc", "--komi abc --log 0 --out bench_batch.sgf" },
+};
+static const Int Nbatch = sizeof(batch_runs) / sizeof(batch_runs[0]);
+
+// "go [options]" by batch_solve(), the exit code must be "code"
+// argv[0] is the name, the output file (--out) is removed
+inline Int run_batch(Int_I code, int argc, char *argv[])
+{
+	Int i;
+	slisc::Timer timer; timer.tic();
+	Int ret = batch_solve(argc, argv);
+	Doub time = timer.toc();
+	for (i = 1; i + 1 < argc; ++i)
+		if (strcmp(argv[i], "--out") == 0)
+			remove(argv[i + 1]);
+	Bool ok = ret == code;
+	printf("{\"name\": \"batch_%s\", \"time\": %.6f, \"exit_code\": %d, \"expected_exit_code\": %d, \"ok\": %s}\n",
+		argv[0], time, ret, code, ok ? "true" : "false");
+	fflush(stdout);
+	return ok ? 0 : 1;
+}
+
+// replay an SGF file
+inline Int run_sgf(const char *fname)
+{
+	Int Nx = 0, Ny = 0;
+	std::ifstream fin(fname);
+	if (!fin)
+		error("failed to open SGF file!");
+	string sgf((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+	if (!sgf_size(Nx, Ny, sgf))
+		error("board size not found in SGF file!");
+	board_Nx(Nx); board_Ny(Ny);
+	PerftCount count;
+	slisc::Timer timer; timer.tic();
+	sgf_replay(count, sgf);
+	Doub time = timer.toc();
+	printf("{\"name\": \"sgf\", \"file\": \"%s\", \"Nx\": %d, \"Ny\": %d, \"time\": %.6f, "
+		"\"lines\": %lld, \"moves\": %lld, \"illegal\": %lld, \"moves_per_sec\": %.1f}\n",
+		fname, Nx, Ny, time, (long long)count.leaves, (long long)count.positions, (long long)count.illegal,
+		count.positions / MAX(time, 1e-9));
+	return count.illegal == 0 ? 0 : 1;
+}
+
+// concurrent insert-or-get of a Pool
+// every thread inserts the same random configs (half of them repeated) in its own order, then links them
+// checked: all threads get the same pool index for a config, the number of entries is the number of distinct
+// configs, the entries hold the configs, search() agrees, and all threads see the same owner of a situation
+inline Int run_pool(Int_I Nthread, Long_I Nconfig)
+{
+	Long i, j;
+	Int t;
+	board_Nx(5); board_Ny(5);
+	Bits board = bit_geom().m_board;
+	std::mt19937_64 gen(1);
+	vector<Config> configs(Nconfig);
+	for (i = 0; i < Nconfig; ++i) {
+		if (i % 2 == 1)
+			configs[i] = configs[gen() % i]; // repeated
+		else {
+			Bits black = gen() & board, white = gen() & board & ~black;
+			configs[i].init(black, white);
+			configs[i].canonicalize(Trans());
+		}
+	}
+
+	Pool pool;
+	vector<vector<Long>> inds(Nthread, vector<Long>(Nconfig)), owners(Nthread, vector<Long>(Nconfig));
+	vector<std::thread> threads;
+	slisc::Timer timer; timer.tic();
+	for (t = 0; t < Nthread; ++t) {
+		threads.emplace_back([&, t]() {
+			Long k, ind;
+			for (k = 0; k < Nconfig; ++k) {
+				// each thread starts at another place, odd threads go backward
+				ind = (k + t * Nconfig / Nthread) % Nconfig;
+				if (t % 2)
+					ind = Nconfig - 1 - ind;
+				pool.insert(inds[t][ind], configs[ind]);
+			}
+			for (k = 0; k < Nconfig; ++k)
+				owners[t][k] = pool.link(inds[t][k], Who::BLACK, t);
+		});
+	}
+	for (t = 0; t < Nthread; ++t)
+		threads[t].join();
+	Doub time = timer.toc();
+
+	Bool ok = true;
+	vector<std::pair<Ullong, Ullong>> codes(Nconfig);
+	for (i = 0; i < Nconfig; ++i) {
+		ConfigCode code = configs[i].code();
+		codes[i] = std::make_pair(code.m_black, code.m_white);
+		for (t = 1; t < Nthread; ++t)
+			if (inds[t][i] != inds[0][i] || owners[t][i] != owners[0][i])
+				ok = false;
+		if (!(pool(inds[0][i]).code() == code) || pool.search(j, configs[i]) != 0 || j != inds[0][i]
+			|| pool.treeInd(inds[0][i], Who::BLACK) != owners[0][i])
+			ok = false;
+	}
+	std::sort(codes.begin(), codes.end());
+	Long Ndistinct = std::unique(codes.begin(), codes.end()) - codes.begin();
+	if (pool.size() != Ndistinct)
+		ok = false;
+
+	printf("{\"name\": \"pool\", \"threads\": %d, \"configs\": %lld, \"distinct\": %lld, \"pool\": %lld, "
+		"\"time\": %.6f, \"inserts_per_sec\": %.1f, \"ok\": %s}\n",
+		Nthread, (long long)Nconfig, (long long)Ndistinct, (long long)pool.size(), time,
+		Nthread * Nconfig / MAX(time, 1e-9), ok ? "true" : "false");
+	fflush(stdout);
+	return ok ? 0 : 1;
+}
+
+// run a child process (this program with 'args'), and print the last JSON object it prints
+// return 0 if the child returned 0 and printed a result
+inline Int run_child(const char *prog, const string &args, const string &name, Bool_I first)
+{
+	string cmd = string("\"") + prog + "\" " + args;
+	FILE *pipe = popen(cmd.c_str(), "r");
+	if (!pipe)
+		error("failed to run a workload!");
+	char line[4096];
+	string result;
+	while (fgets(line, sizeof(line), pipe))
+		if (line[0] == '{')
+			result = line;
+	Int ret = pclose(pipe);
+	if (result.empty()) {
+		// crashed or did not finish
+		result = string("{\"name\": \"") + name + "\", \"ok\": false}\n";
+		ret = 1;
+	}
+	result.erase(result.find_last_not_of("\r\n") + 1);
+	printf("%s%s", first ? "" : ",\n", result.c_str());
+	fflush(stdout);
+	return ret == 0 ? 0 : 1;
+}
+
+int main(int argc, char *argv[])
+{
+	Int i, Nfail = 0;
+	Bool full = false;
+
+	if (argc > 2 && strcmp(argv[1], "--run") == 0) {
+		i = atoi(argv[2]);
+		if (i < 0 || i >= Nworkload)
+			error("workload index out of range!");
+		return run(i);
+	}
+	if (argc > 4 && strcmp(argv[1], "--perft") == 0)
+		return run_perft(atoi(argv[2]), atoi(argv[3]), atoi(argv[4]));
+	if (argc > 2 && strcmp(argv[1], "--sgf") == 0)
+		return run_sgf(argv[2]);
+	if (argc > 2 && strcmp(argv[1], "--search") == 0) {
+		i = atoi(argv[2]);
+		if (i < 0 || i >= Nworkload)
+			error("workload index out of range!");
+		return run_search(i);
+	}
+	if (argc > 3 && strcmp(argv[1], "--reuse") == 0)
+		return run_reuse(atoi(argv[2]), atoi(argv[3]));
+	if (argc > 3 && strcmp(argv[1], "--split") == 0) {
+		i = atoi(argv[2]);
+		if (i < 0 || i >= Nworkload)
+			error("workload index out of range!");
+		return run_split(i, atoi(argv[3]));
+	}
+	if (argc > 3 && strcmp(argv[1], "--pool") == 0)
+		return run_pool(atoi(argv[2]), atoll(argv[3]));
+	if (argc > 3 && strcmp(argv[1], "--batch") == 0)
+		return run_batch(atoi(argv[2]), argc - 3, argv + 3);
+	if (argc > 1 && strcmp(argv[1], "--full") == 0)
+		full = true;
+
+	// run each workload in a child process, keep the line of the JSON object
+	printf("[\n");
+	Bool first = true;
+	for (i = 0; i < Nworkload; ++i) {
+		if (workloads[i].full && !full)
+			continue;
+		Nfail += run_child(argv[0], "--run " + num2str(i), workloads[i].name, first);
+		first = false;
+	}
+	Nfail += run_child(argv[0], "--reuse 3 4", "reuse", first); // 3x3, then 3x3 after bb
+	for (i = 0; i < Nsearch; ++i)
+		Nfail += run_child(argv[0], "--search " + num2str(search_workloads[i].ind),
+			string("search_") + workloads[search_workloads[i].ind].name, false);
+	Nfail += run_child(argv[0], "--pool 8 200000", "pool", false);
+	Nfail += run_child(argv[0], "--split 4 4", "split_3x3_k8.5_bb", false); // every child in a thread
+	Nfail += run_child(argv[0], "--split 6 4", "split_3x4_k0.5", false); // the first child is good
+	Nfail += run_child(argv[0], "--perft 3 3 6", "perft", false);
+	for (i = 0; i < Nbatch; ++i)
+		Nfail += run_child(argv[0], string("--batch ") + batch_runs[i][0] + " " + batch_runs[i][1] + " " + batch_runs[i][2],
+			string("batch_") + batch_runs[i][1], false);
+	printf("\n]\n");
+	return Nfail == 0 ? 0 : 1;
+}
@@ -0,0 +1,199 @@
+#pragma once
+#include "common.h"
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// bit operations for configurations stored as bitboards
+// a board with Nx*Ny <= 64 points fits in one 64 bit word
+// point (x, y) is stored in bit x + Nx*y, so bit order is the same as the row-major order
+typedef Ullong Bits;
+typedef const Bits Bits_I;
+typedef Bits &Bits_O, &Bits_IO;
+
+// number of set bits
+inline Int popcount(Bits_I b)
+{
+#ifdef _MSC_VER
+	return (Int)__popcnt64(b);
+#else
+	return __builtin_popcountll(b);
+#endif
+}
+
+// index of the lowest set bit, b must not be 0
+inline Int lowbit_ind(Bits_I b)
+{
+#ifdef _MSC_VER
+	unsigned long ind;
+	_BitScanForward64(&ind, b);
+	return (Int)ind;
+#else
+	return __builtin_ctzll(b);
+#endif
+}
+
+// lowest set bit only
+inline Bits lowbit(Bits_I b)
+{
+	return b & (~b + 1);
+}
+
+// masks of the board geometry
+class BitGeom
+{
+public:
+	Char m_Nx, m_Ny;
+	Bits m_board; // all points on board
+	Bits m_left; // points with x == 0
+	Bits m_right; // points with x == Nx - 1
+	Bits m_top; // points with y == 0
+	Bits m_bottom; // points with y == Ny - 1
+
+	BitGeom(Char_I Nx, Char_I Ny) : m_Nx(Nx), m_Ny(Ny)
+	{
+		Char x, y;
+		if (Nx * Ny > 64)
+			error("BitGeom: board larger than 64 points is not supported!");
+		m_board = m_left = m_right = m_top = m_bottom = 0;
+		for (y = 0; y < Ny; ++y) {
+			for (x = 0; x < Nx; ++x) {
+				Bits b = Bits(1) << (x + Nx * y);
+				m_board |= b;
+				if (x == 0) m_left |= b;
+				if (x == Nx - 1) m_right |= b;
+				if (y == 0) m_top |= b;
+				if (y == Ny - 1) m_bottom |= b;
+			}
+		}
+	}
+};
+
+// board geometry, built on first use (board size must be set before)
+inline const BitGeom & bit_geom()
+{
+	static const BitGeom geom(board_Nx(), board_Ny());
+	return geom;
+}
+
+// runtime board geometry for the kernels below, see bit_geom()
+class BitGeomR
+{
+public:
+	static Int Nx() { return bit_geom().m_Nx; }
+	static Bits board() { return bit_geom().m_board; }
+	static Bits left() { return bit_geom().m_left; }
+	static Bits right() { return bit_geom().m_right; }
+	static Bits top() { return bit_geom().m_top; }
+	static Bits bottom() { return bit_geom().m_bottom; }
+};
+
+// compile-time board geometry for the kernels below
+// all masks are constant expressions, so loops over the board can be unrolled
+template <Int Nx0, Int Ny0>
+class BitGeomT
+{
+public:
+	static constexpr Bits column(Int_I x)
+	{
+		Bits b = 0;
+		for (Int y = 0; y < Ny0; ++y)
+			b |= Bits(1) << (x + Nx0 * y);
+		return b;
+	}
+
+	static constexpr Int Nx() { return Nx0; }
+	static constexpr Bits board() { return Nx0 * Ny0 == 64 ? ~Bits(0) : (Bits(1) << (Nx0 * Ny0)) - 1; }
+	static constexpr Bits left() { return column(0); }
+	static constexpr Bits right() { return column(Nx0 - 1); }
+	static constexpr Bits top() { return (Bits(1) << Nx0) - 1; }
+	static constexpr Bits bottom() { return top() << (Nx0 * (Ny0 - 1)); }
+};
+
+// bit of a point
+inline Bits bit(Char_I x, Char_I y)
+{
+	return Bits(1) << (x + board_Nx() * y);
+}
+
+// all points adjacent to any point in b (may overlap b)
+template <class G>
+inline Bits nbr(Bits_I b)
+{
+	return (((b & ~G::right()) << 1) | ((b & ~G::left()) >> 1)
+		| (b << G::Nx()) | (b >> G::Nx())) & G::board();
+}
+
+inline Bits nbr(Bits_I b) { return nbr<BitGeomR>(b); }
+
+// points whose neighbours on board are all in b
+// (a point is considered surrounded in the direction of the board edge)
+template <class G>
+inline Bits surrounded(Bits_I b)
+{
+	return ((b << 1) | G::left()) & ((b >> 1) | G::right())
+		& ((b << G::Nx()) | G::top()) & ((b >> G::Nx()) | G::bottom()) & G::board();
+}
+
+inline Bits surrounded(Bits_I b) { return surrounded<BitGeomR>(b); }
+
+// all points in "mask" connected to "seed" through points in "mask"
+// iterative, seed should be a subset of mask
+template <class G>
+inline Bits flood(Bits_I seed, Bits_I mask)
+{
+	Bits b = seed & mask, b1;
+	for (;;) {
+		b1 = (b | nbr<G>(b)) & mask;
+		if (b1 == b)
+			return b;
+		b = b1;
+	}
+}
+
+inline Bits flood(Bits_I seed, Bits_I mask) { return flood<BitGeomR>(seed, mask); }
+
+// random keys for zobrist hashing
+// generated with a fixed seed so that hashes are reproducible between runs
+class ZobristKeys
+{
+public:
+	Ullong m_key[2][64]; // [0]: black, [1]: white
+
+	ZobristKeys()
+	{
+		Int i, j;
+		Ullong z, seed = 0x9E3779B97F4A7C15ULL;
+		for (i = 0; i < 2; ++i) {
+			for (j = 0; j < 64; ++j) {
+				// splitmix64
+				z = (seed += 0x9E3779B97F4A7C15ULL);
+				z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+				z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+				m_key[i][j] = z ^ (z >> 31);
+			}
+		}
+	}
+};
+
+inline const ZobristKeys & zobrist_keys()
+{
+	static const ZobristKeys keys;
+	return keys;
+}
+
+// zobrist key of a stone of "who" at bit index "ind"
+inline Ullong zobrist(Int_I ind, Who_I who)
+{
+	return zobrist_keys().m_key[who == Who::BLACK ? 0 : 1][ind];
+}
+
+// zobrist hash of all stones of "who" in "b"
+inline Ullong zobrist(Bits_I b, Who_I who)
+{
+	const Ullong *key = zobrist_keys().m_key[who == Who::BLACK ? 0 : 1];
+	Ullong hash = 0;
+	for (Bits b1 = b; b1; b1 &= b1 - 1)
+		hash ^= key[lowbit_ind(b1)];
+	return hash;
+}
@@ -8,7 +8,7 @@
 class BoardRef
 {
 private:
-	const Config & m_config;
+	Config m_config; // unpacked from Pool
 	Trans m_trans; // trans needed from m_config to actual board
 
 public:
@@ -36,6 +36,12 @@ public:
 		return m_trans;
 	}
 
+	// the actual board (transformed) as a config
+	void actual_config(Config_O config) const
+	{
+		m_config.transform(config, m_trans);
+	}
+
 	// check if a placing is legal, or how many stones will be dead
 	// same check already exists for place()
 	// Ko is not considered!
@@ -0,0 +1,264 @@
+#pragma once
+#include "common.h"
+#include <cstdio>
+#include <cstring>
+#include <csignal>
+#include <atomic>
+#include <type_traits>
+#ifndef _MSC_VER
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// binary checkpoint of a Tree (see Tree::checkpoint())
+// the file is a header and flat arrays, each array is its size (Long) and the raw elements, padded to 8 bytes
+// links are stored as 1 + their index in the LinkArena (0 for null), and fixed up to pointers on restore
+// the elements are written in their memory layout (with padding), only little-endian hosts are supported,
+// and the header records the sizes of the stored types so that a checkpoint of another build is rejected
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "checkpoint.h: checkpoints are only supported on little-endian hosts!"
+#endif
+
+static const Int ckpt_version = 2; // 2: ko links keyed by Link::key()
+
+// header of a checkpoint file
+class CkptHeader
+{
+public:
+	char m_magic[8]; // "GOSCKPT"
+	Int m_version;
+	Int m_endian; // 0x01020304, written by a little-endian host
+	Int m_Nx, m_Ny, m_komi2;
+	Int m_size_next, m_size_last, m_size_link; // sizeof() of LinkList<4>, LinkList<2> and Link, to reject other builds
+
+	// fill with the current build and board
+	void init();
+
+	// return an error message if a checkpoint can't be read by this build, or nullptr
+	const char *invalid() const;
+
+};
+
+// write a checkpoint file
+// written to "name.tmp" and renamed by close(), so a crash never leaves a broken checkpoint
+class CkptWriter
+{
+private:
+	FILE *m_file;
+	string m_name;
+
+public:
+	CkptWriter(const string &name) : m_name(name)
+	{
+		m_file = fopen((name + ".tmp").c_str(), "wb");
+		if (!m_file)
+			error("failed to open checkpoint file!");
+	}
+
+	void write_raw(const void *data, Long_I nbyte)
+	{
+		if (nbyte > 0 && fwrite(data, 1, nbyte, m_file) != (size_t)nbyte)
+			error("failed to write checkpoint file!");
+	}
+
+	// pad after 'nbyte' bytes of write_raw()
+	void pad(Long_I nbyte)
+	{
+		static const char zeros[8] = {};
+		if (nbyte % 8)
+			write_raw(zeros, 8 - nbyte % 8);
+	}
+
+	// an array with elements converted by 'f' (e.g. pointers to indices), same format as write(data, n)
+	template <class T, class F>
+	void write(const T *data, Long_I n, F f)
+	{
+		static const Long Nbuf = 4096;
+		vector<T> buf(MIN(Nbuf, n));
+		write(n);
+		for (Long i = 0; i < n; i += Nbuf) {
+			Long m = MIN(Nbuf, n - i);
+			for (Long j = 0; j < m; ++j)
+				buf[j] = f(data[i + j]);
+			write_raw(buf.data(), m * sizeof(T));
+		}
+		pad(n * sizeof(T));
+	}
+
+	// a trivially copyable value, padded
+	template <class T>
+	void write(const T &val)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "not trivially copyable!");
+		write_raw(&val, sizeof(T)); pad(sizeof(T));
+	}
+
+	// an array of trivially copyable elements
+	template <class T>
+	void write(const T *data, Long_I n)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "not trivially copyable!");
+		write(n);
+		write_raw(data, n * sizeof(T)); pad(n * sizeof(T));
+	}
+
+	template <class T>
+	void write(const vector<T> &v) { write(v.data(), (Long)v.size()); }
+
+	void close()
+	{
+		if (fclose(m_file) != 0)
+			error("failed to write checkpoint file!");
+		m_file = nullptr;
+		std::remove(m_name.c_str());
+		if (std::rename((m_name + ".tmp").c_str(), m_name.c_str()) != 0)
+			error("failed to rename checkpoint file!");
+	}
+
+	~CkptWriter() { if (m_file) fclose(m_file); }
+};
+
+// read a checkpoint file, mapped to memory (read into a buffer for MSVC)
+class CkptReader
+{
+private:
+	const char *m_data;
+	Long m_size, m_pos;
+#ifdef _MSC_VER
+	vector<char> m_buf;
+#endif
+
+	const char *read_raw(Long_I nbyte)
+	{
+		if (m_pos + nbyte > m_size)
+			error("checkpoint file is truncated!");
+		const char *p = m_data + m_pos;
+		m_pos += (nbyte + 7) / 8 * 8;
+		return p;
+	}
+
+public:
+	CkptReader(const string &name) : m_data(nullptr), m_size(0), m_pos(0)
+	{
+#ifdef _MSC_VER
+		FILE *file = fopen(name.c_str(), "rb");
+		if (!file)
+			error("failed to open checkpoint file!");
+		_fseeki64(file, 0, SEEK_END); m_size = _ftelli64(file); _fseeki64(file, 0, SEEK_SET);
+		m_buf.resize(m_size);
+		if (fread(m_buf.data(), 1, m_size, file) != (size_t)m_size)
+			error("failed to read checkpoint file!");
+		fclose(file);
+		m_data = m_buf.data();
+#else
+		Int fd = open(name.c_str(), O_RDONLY);
+		struct stat st;
+		if (fd < 0 || fstat(fd, &st) != 0)
+			error("failed to open checkpoint file!");
+		m_size = st.st_size;
+		void *p = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		::close(fd);
+		if (p == MAP_FAILED)
+			error("failed to map checkpoint file!");
+		madvise(p, m_size, MADV_SEQUENTIAL);
+		m_data = (const char *)p;
+#endif
+	}
+
+	CkptReader(const CkptReader &) = delete;
+	CkptReader & operator=(const CkptReader &) = delete;
+
+	template <class T>
+	void read(T &val)
+	{
+		memcpy(&val, read_raw(sizeof(T)), sizeof(T));
+	}
+
+	// an array written by CkptWriter::write(data, n), return the elements in the file
+	template <class T>
+	const T * read_array(Long_O n)
+	{
+		read(n);
+		return (const T *)read_raw(n * sizeof(T));
+	}
+
+	template <class T>
+	void read(vector<T> &v)
+	{
+		Long n;
+		const T *p = read_array<T>(n);
+		v.assign(p, p + n);
+	}
+
+	~CkptReader()
+	{
+#ifndef _MSC_VER
+		if (m_data)
+			munmap((void *)m_data, m_size);
+#endif
+	}
+};
+
+inline void CkptHeader::init()
+{
+	memset(this, 0, sizeof(*this));
+	strcpy(m_magic, "GOSCKPT");
+	m_version = ckpt_version; m_endian = 0x01020304;
+	m_Nx = board_Nx(); m_Ny = board_Ny(); m_komi2 = komi2();
+}
+
+inline const char *CkptHeader::invalid() const
+{
+	if (strncmp(m_magic, "GOSCKPT", sizeof(m_magic)) != 0)
+		return "not a checkpoint file!";
+	if (m_version != ckpt_version)
+		return "unsupported checkpoint version!";
+	if (m_endian != 0x01020304)
+		return "not a little-endian checkpoint!";
+	if (m_Nx < 1 || m_Ny < 1 || m_Nx * m_Ny > 64)
+		return "checkpoint of an illegal board size!";
+	return nullptr;
+}
+
+// read the header of a checkpoint, e.g. to set the board size before constructing a Tree
+// return an error message if the file can't be read or the header is invalid, or nullptr
+inline const char *checkpoint_header(CkptHeader &header, const string &name)
+{
+	FILE *file = fopen(name.c_str(), "rb");
+	if (!file)
+		return "failed to open checkpoint file!";
+	Bool ok = fread(&header, sizeof(header), 1, file) == 1;
+	fclose(file);
+	if (!ok)
+		return "failed to read checkpoint file!";
+	return header.invalid();
+}
+
+// checkpoint requested by a signal, checked by Tree::solve()
+// 0: none, 1: write a checkpoint and continue (SIGUSR1), 2: write a checkpoint and exit (SIGINT)
+inline std::atomic<Int> &checkpoint_signal()
+{
+	static std::atomic<Int> sig(0);
+	return sig;
+}
+
+extern "C" inline void checkpoint_signal_handler(int sig)
+{
+	// a second SIGINT exits at once, solve() might not check the first one (e.g. writing the SGF file)
+	if (sig == SIGINT && checkpoint_signal().load() == 2)
+		std::_Exit(130);
+	checkpoint_signal().store(sig == SIGINT ? 2 : 1);
+}
+
+// request a checkpoint from Tree::solve() on SIGUSR1 (continue) and SIGINT (exit)
+// batch_solve() returns 130 for a SIGINT after solve()
+inline void install_checkpoint_signals()
+{
+	std::signal(SIGINT, checkpoint_signal_handler);
+#ifdef SIGUSR1
+	std::signal(SIGUSR1, checkpoint_signal_handler);
+#endif
+}
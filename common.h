@@ -14,11 +14,35 @@
 #include "SLISC/random.h"
 #include "SLISC/search.h"
 #include "SLISC/time.h"
+#include <sstream>
+#include <stdexcept>
 
 using namespace slisc;
 using std::vector; using std::string;
 using std::ofstream; using std::cout;
-using std::cin; using std::endl;
+using std::cin; using std::cerr; using std::endl;
+
+// error() of SLISC waits for a key after the message, which blocks a run without a user
+// after error_throw(1) it throws ErrorGo instead (see batch_solve())
+class ErrorGo : public std::runtime_error
+{
+public:
+	ErrorGo(const string &msg) : std::runtime_error(msg) {}
+};
+
+// set (1 or 0) or get if error() throws
+inline Bool error_throw(Int_I set = -1)
+{
+	static Bool throw0 = false;
+	if (set >= 0)
+		throw0 = set;
+	return throw0;
+}
+
+#undef error
+#define error(msg) do{std::ostringstream os_; os_ << __FILE__ << ": line " << __LINE__ << ": " << msg; \
+	if (error_throw()) throw ErrorGo(os_.str()); \
+	std::cout << "error: " << os_.str() << std::endl; getchar();} while(0)
 
 class Trans;
 typedef const Trans &Trans_I;
@@ -250,70 +274,6 @@ inline Trans inv(Trans_I trans)
 	return out;
 }
 
-// transform coordinates
-inline void transf(Char_IO x, Char_IO y, Int_I rot)
-{
-	Char temp, xmax = board_Nx() - 1, ymax = board_Ny() - 1;
-	if (rot == 1) {
-		temp = x; x = y; y = xmax - temp;
-	}
-	else if (rot == 2) {
-		x = xmax - x; y = ymax-y;
-	}
-	else if (rot == 3) {
-		temp = x; x = ymax - y; y = temp;
-	}
-}
-
-// transform coordinates and who
-inline void transf(Char_IO x, Char_IO y, Who_O who, Trans_I trans)
-{
-	Char temp, xmax = board_Nx() - 1, ymax = board_Ny() - 1;
-	if (trans.rot() == 1) {
-		temp = x; x = y; y = xmax-temp;
-	}
-	else if (trans.rot() == 2) {
-		x = xmax-x; y = ymax-y;
-	}
-	else if (trans.rot() == 3) {
-		temp = x; x = ymax-y; y = temp;
-	}
-	if (trans.flip())
-		who = next(who);
-}
-
-// inverse transform coordinates
-inline void inv_transf(Char_IO x, Char_IO y, Int_I rot)
-{
-	Char temp, xmax = board_Nx() - 1, ymax = board_Ny() - 1;
-	if (rot == 1) {
-		temp = x; x = ymax-y; y = temp;
-	}
-	else if (rot == 2) {
-		x = xmax-x; y = ymax-y;
-	}
-	else if (rot == 3) {
-		temp = x; x = y; y = xmax-temp;
-	}
-}
-
-// inverse transform coordinates and who
-inline void inv_transf(Char_IO x, Char_IO y, Who_O who, Trans trans)
-{
-	Char temp, xmax = board_Nx() - 1, ymax = board_Ny() - 1;
-	if (trans.rot() == 1) {
-		temp = x; x = ymax-y; y = temp;
-	}
-	else if (trans.rot() == 2) {
-		x = xmax-x; y = ymax-y;
-	}
-	else if (trans.rot() == 3) {
-		temp = x; x = y; y = xmax-temp;
-	}
-	if (trans.flip())
-		who = next(who);
-}
-
 // convert from trans to an unique integer
 Int trans2int(Trans_I trans)
 {
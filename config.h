@@ -1,6 +1,25 @@
 #pragma once
 #include "group.h"
-#include "SLISC/sort.h"
+#include "geometry.h"
+#include "rules.h"
+#include "prof.h"
+
+// packed configuration for storage (16 bytes, see Pool)
+// same stones as Config, without the hash
+class ConfigCode
+{
+public:
+	Bits m_black;
+	Bits m_white;
+
+	Bool operator==(const ConfigCode &rhs) const
+	{
+		return m_black == rhs.m_black && m_white == rhs.m_white;
+	}
+};
+
+typedef const ConfigCode &ConfigCode_I;
+typedef ConfigCode &ConfigCode_O, &ConfigCode_IO;
 
 // board configuration, not situation
 // for raw board, class RawBoard must be used
@@ -11,7 +30,9 @@ class Config
 {
 private:
 	// === data member ===
-	Matrix<Who> m_data;
+	Bits m_black; // black stones, see bitboard.h for bit order
+	Bits m_white; // white stones
+	Ullong m_hash; // zobrist hash of all stones, updated incrementally
 
 public:
 	// === constructors ===
@@ -22,7 +43,26 @@ public:
 	// get a stone by coordinate
 	Who operator()(Char_I x, Char_I y) const;
 
-	Who & operator()(Char_I x, Char_I y);
+	// stones of one side
+	Bits stones(Who_I who) const;
+
+	// packed config for storage
+	ConfigCode code() const;
+
+	// zobrist hash of the config
+	// configs in the Pool are already canonicalized by calc_trans(), so this is also the hash
+	// of the symmetry-canonical config
+	Ullong hash() const;
+
+	// all empty points
+	Bits empty() const;
+
+	// stones connected to "stone" (a single bit) with the same color "who"
+	// "stone" can be an empty point (assume a stone of "who" is placed)
+	Bits group(Bits_I stone, Who_I who) const;
+
+	// qi's of a group
+	Bits qi(Bits_I group) const;
 
 	// display config on screen
 	void disp() const;
@@ -35,26 +75,8 @@ public:
 	// return -2 if no qi, do nothing
 	Int check(Char_I x, Char_I y, Who_I s) const;
 
-	// get stones connected to a given stone (x,y) and calculate qi
-	// if (x,y) does not have a stone yet, specifying "who" can assume a stone is placed
-	// if (x,y) already have a stone, "who" argument is not used
-	// "mark" will mark connected stones and their qi.
-	// "group" has the coordinates of the connected stones
-	void connect(MatChar_O mark, vector<Move> &qi, vector<Move> /*_O*/ &group,
-		Char_I x, Char_I y, Who_I who = Who::DEFAULT) const;
-
-	// internal recursive function called by connect()
-	void connect0(MatChar_IO mark, vector<Move> &qi, vector<Move> /*_IO*/ &group,
-		Char_I x, Char_I y, Who_I who = Who::DEFAULT) const;
-
-	// get all qi's connected to one qi
-	void connect_qi(MatChar_O mark, vector<Move> /*_O*/ &group, Char_I x, Char_I y) const;
-
-	// internal recursive function called by connect_qi()
-	void connect_qi0(MatChar_IO mark, vector<Move> /*_IO*/ &group, Char_I x, Char_I y) const;
-
 	// remove a group of stone from the board
-	void remove_group(const vector<Move> &group);
+	void remove_group(Bits_I group);
 
 	// if the game has ended
 	// game only ends when only eyes and mutual life (two qi's) are left
@@ -83,65 +105,12 @@ public:
 	// check atari for opponent group, generate all available moves and try to put the better moves first
 	// for now, order the moves according to # of stones that can be removed
 	// the moves only includes placing, not passing
-	void eat_list(vector<Move> &pos, Who_I who) const
-	{
-		using slisc::sort2;
-		Int i, Nqi, Ndead, Ngroup;
-		vector<Group> groups;
-		vector<Int> dead_group_inds;
-		vector<Int> dead_group_size;
-
-		pos.resize(0);
-		all_groups(groups, ::next(who));
-		Ngroup = groups.size();
-
-		for (i = 0; i < groups.size(); ++i) {
-			Nqi = groups[i].qi().size();
-			if (Nqi == 1) {
-				dead_group_inds.push_back(i);
-				dead_group_size.push_back(Nqi);
-			}
-		}
-
-		Ndead = dead_group_inds.size();
-		
-		if (Ndead == 0)
-			return;
-		else if (Ndead == 1) {
-			pos.push_back(groups[dead_group_inds[0]].qi()[0]);
-			return;
-		}
-		else {
-			// more than one dead group
-			sort2(dead_group_size, dead_group_inds); // ascending order
-			pos.resize(Ndead);
-			for (i = Ndead - 1; i >= 0; --i) {
-				pos[i] = groups[dead_group_inds[i]].qi()[0];
-			}
-		}
-	}
+	void eat_list(vector<Move> &pos, Who_I who) const;
 
 	// find all groups for a player
-	void all_groups(vector<Group> &groups, Who_I who) const
-	{
-		Char x, y, Nx = board_Nx(), Ny = board_Ny();
-		Int i;
-		MatChar tot_mark(Nx, Ny, Char(0)), mark;
-		Group group;
-		for (y = 0; y < Ny; ++y) {
-			for (x = 0; x < Nx; ++x) {
-				if (m_data(x, y) == who && !tot_mark(x, y)) {
-					groups.push_back(Group());
-					vector<Move> &qi = groups.back().qi();
-					vector<Move> &group = groups.back().pos();
-					connect(mark, qi, group, x, y, who);
-					for (i = 0; i < group.size(); ++i) {
-						tot_mark(group[i].x(), group[i].y()) = 1;
-					}
-				}
-			}
-		}
-	}
+	// "groups" must have at least Ngroup_max elements
+	// return the number of groups
+	Int all_groups(Group *groups, Who_I who) const;
 
 	// decide the best transformations (rotation and stone color flipping) to make a configuration "largest"
 	// NONE:0 < WHITE:1 < BLACK:2
@@ -150,6 +119,9 @@ public:
 	// output rot: times the board needs to rotate counter-clockwise
 	Trans calc_trans(Trans_I trans) const;
 
+	// same as calc_trans(), also output the stones of the transformed board
+	Trans calc_trans(Bits_O black, Bits_O white, Trans_I trans) const;
+
 	// get a stone after the board has been rotated and fliped
 	Who transform1(Char_I x, Char_I y, Trans_I trans) const;
 
@@ -160,12 +132,22 @@ public:
 
 	void init(); // init to an empty board
 
+	void init(Bits_I black, Bits_I white); // init to given stones
+
+	void init(ConfigCode_I code); // unpack a stored config
+
+	// set a stone (or Who::NONE) by coordinate
+	void set(Char_I x, Char_I y, Who_I who);
+
 	// move internal data from one config to another without copying
 	void operator<<(Config_IO rhs);
 
 	// transform a board itself
 	void transform(Trans_I trans);
 
+	// transform a board itself with calc_trans(), return the transformation
+	Trans canonicalize(Trans_I trans_ref);
+
 	// return 0 if legal, and update board
 	// Ko is not considered! 
 	// return -1 if occupied, do nothing
@@ -186,12 +168,68 @@ inline Int operator-(Config_I config1, Config_I config2);
 
 inline Who Config::operator()(Char_I x, Char_I y) const
 {
-	return m_data(x, y);
+	Bits b = bit(x, y);
+	if (m_black & b)
+		return Who::BLACK;
+	if (m_white & b)
+		return Who::WHITE;
+	return Who::NONE;
+}
+
+inline Bits Config::stones(Who_I who) const
+{
+	if (who == Who::BLACK)
+		return m_black;
+	else if (who == Who::WHITE)
+		return m_white;
+	error("illegal who!");
+	return 0;
+}
+
+inline ConfigCode Config::code() const
+{
+	ConfigCode code;
+	code.m_black = m_black; code.m_white = m_white;
+	return code;
+}
+
+inline Ullong Config::hash() const
+{
+	return m_hash;
+}
+
+inline Bits Config::empty() const
+{
+	return bit_geom().m_board & ~(m_black | m_white);
+}
+
+inline Bits Config::group(Bits_I stone, Who_I who) const
+{
+	return flood(stone, stones(who) | stone);
+}
+
+inline Bits Config::qi(Bits_I group) const
+{
+	return nbr(group) & empty();
 }
 
-inline Who & Config::operator()(Char_I x, Char_I y)
+inline void Config::set(Char_I x, Char_I y, Who_I who)
 {
-	return m_data(x, y);
+	Bits b = bit(x, y);
+	Int ind = lowbit_ind(b);
+	if (m_black & b)
+		m_hash ^= zobrist(ind, Who::BLACK);
+	else if (m_white & b)
+		m_hash ^= zobrist(ind, Who::WHITE);
+	m_black &= ~b; m_white &= ~b;
+	if (who == Who::BLACK) {
+		m_black |= b; m_hash ^= zobrist(ind, Who::BLACK);
+	}
+	else if (who == Who::WHITE) {
+		m_white |= b; m_hash ^= zobrist(ind, Who::WHITE);
+	}
+	else if (who != Who::NONE)
+		error("illegal who!");
 }
 
 inline void Config::disp() const
@@ -204,11 +242,11 @@ inline void Config::disp() const
 	for (y = 0; y < Ny; ++y) {
 		cout << " " << Int(y) << " |";
 		for (x = 0; x < Nx; ++x) {
-			if (m_data(x, y) == Who::NONE)
+			if (operator()(x, y) == Who::NONE)
 				cout << "   |";
-			else if (m_data(x, y) == Who::BLACK)
+			else if (operator()(x, y) == Who::BLACK)
 				cout << " @ |";
-			else if (m_data(x, y) == Who::WHITE)
+			else if (operator()(x, y) == Who::WHITE)
 				cout << " O |";
 			else
 				error("Config::disp(): illegal stone code!");
@@ -219,634 +257,217 @@ inline void Config::disp() const
 	}
 }
 
+// compare two configs given as stones, see operator-(Config_I, Config_I)
+inline Int compare_stones(Bits_I black1, Bits_I white1, Bits_I black2, Bits_I white2)
+{
+	Bits diff = (black1 ^ black2) | (white1 ^ white2), b;
+	if (!diff)
+		return 0;
+	b = lowbit(diff);
+	// BLACK > WHITE > NONE
+	if (black1 & b)
+		return 1;
+	if (black2 & b)
+		return -1;
+	return (white1 & b) ? 1 : -1;
+}
+
 // if there are multiple trans available,
 // use the one that makes trans2int(trans_ref - trans[i]) smallest
 inline Trans Config::calc_trans(Trans_I trans_ref) const
 {
-	Char x, y;
-	Int i, Nx = board_Nx(), Ny = board_Ny(), N = Nx * Ny, best;
-	vector<Int> val;
-	vector<Bool>;
-	vector<Trans> trans;
-
-	// square board (4 rotations)
-	if (Nx == Ny) {
-		trans.resize(8); val.resize(8);
-		trans[0].set_flip(false); trans[0].set_rot(0);
-		trans[1].set_flip(false); trans[1].set_rot(1);
-		trans[2].set_flip(false); trans[2].set_rot(2);
-		trans[3].set_flip(false); trans[3].set_rot(3);
-		trans[4].set_flip(true);  trans[4].set_rot(0);
-		trans[5].set_flip(true);  trans[5].set_rot(1);
-		trans[6].set_flip(true);  trans[6].set_rot(2);
-		trans[7].set_flip(true);  trans[7].set_rot(3);
-	}
-	// rectangle board (2 rotations)
-	else {
-		trans.resize(4); val.resize(4);
-		trans[0].set_flip(false); trans[0].set_rot(0);
-		trans[1].set_flip(false); trans[1].set_rot(2);
-		trans[2].set_flip(true);  trans[2].set_rot(0);
-		trans[3].set_flip(true);  trans[3].set_rot(2);
-	}
+	Bits black, white;
+	return calc_trans(black, white, trans_ref);
+}
 
-	// check board coordinates in row-major order
-	for (y = 0; y < Ny; ++y) {
-		for (x = 0; x < Nx; ++x) {
-			// evaluate (x, y) position for all transformations left
-			best = 0;
-			for (i = 0; i < val.size(); ++i) {
-				val[i] = who2int(transform1(x, y, trans[i]));
-				if (best < val[i])
-					best = val[i];
-			}
-
-			// only keep the best transformations
-			for (i = 0; i < val.size(); ++i) {
-				if (val[i] < best) {
-					trans.erase(trans.begin() + i);
-					val.erase(val.begin() + i);
-					--i;
-				}
-			}
-
-			// only one transformations left
-			if (val.size() == 1) {
-				return trans[0];
-			}
+// all symmetric boards are generated from the permutation tables in one pass
+inline Trans Config::calc_trans(Bits_O black, Bits_O white, Trans_I trans_ref) const
+{
+	GOS_PROF_SCOPE(Prof::CALC_TRANS);
+	const SymTable &sym = sym_table();
+	Int i, i_best = 0, ret, num, min = 1000000;
+	Bits b, w;
+
+	for (i = 0; i < sym.m_Ntrans; ++i) {
+		if (sym.m_trans[i].flip()) {
+			b = sym.permute(m_white, i); w = sym.permute(m_black, i);
 		}
-	}
-
-	// multiple rot/flip combinations
-	// return the one that makes trans2int(trans0 - trans[i]) smallest
-	Int num, min = 1000000, i_min;
-	for (i = 0; i < trans.size(); ++i) {
-		num = trans2int(trans_ref - trans[i]);
-		if (num < min) {
-			min = num;
-			i_min = i;
+		else {
+			b = sym.permute(m_black, i); w = sym.permute(m_white, i);
+		}
+		ret = i == 0 ? 1 : compare_stones(b, w, black, white);
+		num = trans2int(trans_ref - sym.m_trans[i]);
+		// keep the largest board, for equal boards, keep the one that makes num smallest
+		if (ret > 0 || (ret == 0 && num < min)) {
+			black = b; white = w; i_best = i; min = num;
 		}
 	}
-	return trans[i_min];
+	return sym.m_trans[i_best];
 }
 
 inline Who Config::transform1(Char_I x, Char_I y, Trans_I trans) const
 {
-	Char x1, y1, xmax = board_Nx() - 1, ymax = board_Ny() - 1;
-	Who stone;
-	if (trans.rot() == 0) {
-		x1 = x; y1 = y;
-	}
-	else if (trans.rot() == 1) {
-		x1 = ymax - y; y1 = x;
-	}
-	else if (trans.rot() == 2) {
-		x1 = xmax - x; y1 = ymax - y;
-	}
-	else if (trans.rot() == 3) {
-		x1 = y; y1 = xmax - x;
-	}
-	else
-		error("illegal rotation!");
-
-	stone = m_data(x1, y1);
-	if (trans.flip()) {
-		if (stone == Who::WHITE)
-			return Who::BLACK;
-		if (stone == Who::BLACK)
-			return Who::WHITE;
-	}
-
-	return stone;
+	const SymTable &sym = sym_table();
+	Bits b = Bits(1) << sym.m_inv[sym.index(trans)][x + board_Nx() * y];
+	if (m_black & b)
+		return trans.flip() ? Who::WHITE : Who::BLACK;
+	if (m_white & b)
+		return trans.flip() ? Who::BLACK : Who::WHITE;
+	return Who::NONE;
 }
 
 void Config::transform(Config_O config, Trans_I trans) const
 {
-	Char Nx = board_Nx(), Ny = board_Ny(), x, y;
-	config.init();
-	for (y = 0; y < Ny; ++y) {
-		for (x = 0; x < Nx; ++x) {
-			config(x, y) = transform1(x, y, trans);
-		}
-	}
+	const SymTable &sym = sym_table();
+	Int i = sym.index(trans);
+	if (trans.flip())
+		config.init(sym.permute(m_white, i), sym.permute(m_black, i));
+	else
+		config.init(sym.permute(m_black, i), sym.permute(m_white, i));
 }
 
-// TODO this might be a slow implementation
 void Config::transform(Trans_I trans)
 {
-	Char x1, y1, x, y, Nx = board_Nx(), Ny = board_Ny();
-	Who who1;
 	Config config;
 	transform(config, trans);
 	*this << config;
 }
 
+inline Trans Config::canonicalize(Trans_I trans_ref)
+{
+	Bits black, white;
+	Trans trans = calc_trans(black, white, trans_ref);
+	init(black, white);
+	return trans;
+}
+
 inline Int Config::check(Char_I x, Char_I y, Who_I who) const
 {
+	GOS_PROF_COUNT(Prof::CONFIG_CHECK);
 #ifdef GOS_CHECK_BOUND
 	if (x < 0 || y < 0 || x >= board_Nx() || y >= board_Ny())
 		error("Tree::place(x,y): out of bound!");
 #endif
-	Int Nx = board_Nx(), Ny = board_Ny(), Nremove = 0;
-
-	// output of connect()
-	MatChar mark(Nx, Ny, Char(0)); vector<Move> group; vector<Move> qi;
-
-	// check if already occupied
-	if (m_data(x, y) != Who::NONE)
-		return -1;
-
-	// search opponent's dead stones
-	// only necessary if placed next to opposite stone
-	if (x > 0 && m_data(x - 1, y) == next(who)) {
-		connect(mark, qi, group, x - 1, y);
-		if (qi.size() == 1)
-			Nremove += group.size();
-	}
-
-	if (y > 0 && m_data(x, y - 1) == next(who) && !mark(x, y - 1)) {
-		connect(mark, qi, group, x, y - 1);
-		if (qi.size() == 1)
-			Nremove += group.size();
-	}
-
-	if (x < Nx - 1 && m_data(x + 1, y) == next(who) && !mark(x + 1, y)) {
-		connect(mark, qi, group, x + 1, y);
-		if (qi.size() == 1)
-			Nremove += group.size();
-	}
-
-	if (y < Ny - 1 && m_data(x, y + 1) == next(who) && !mark(x, y + 1)) {
-		connect(mark, qi, group, x, y + 1);
-		if (qi.size() == 1)
-			Nremove += group.size();
-	}
-
-	if (Nremove > 0)
-		return Nremove;
+	return rules().check(stones(who), stones(::next(who)), x + board_Nx() * y);
+}
 
-	// check qi assuming stone is placed
-	connect(mark, qi, group, x, y, who);
-	if (qi.size() == 0) return -2;
+inline void Config::init()
+{
+	bit_geom(); // check board size
+	m_black = m_white = 0;
+	m_hash = 0;
+}
 
-	return 0;
+inline void Config::init(Bits_I black, Bits_I white)
+{
+	m_black = black; m_white = white;
+	m_hash = zobrist(black, Who::BLACK) ^ zobrist(white, Who::WHITE);
 }
 
-inline void Config::init()
+inline void Config::init(ConfigCode_I code)
 {
-	m_data.resize(board_Nx(), board_Ny());
-	m_data = Who::NONE;
+	init(code.m_black, code.m_white);
 }
 
 inline Int Config::place(Char_I x, Char_I y, Who_I who)
 {
+	GOS_PROF_COUNT(Prof::CONFIG_PLACE);
 #ifdef GOS_CHECK_BOUND
 	if (x < 0 || y < 0 || x >= board_Nx() || y >= board_Ny())
 		error("Tree::place(x,y): out of bound!");
 #endif
-	Int Nx = board_Nx(), Ny = board_Ny();
-	Bool removed = false;
-
-	// output of connect()
-	MatChar mark(board_Nx(), board_Ny(), Char(0)); vector<Move> group; vector<Move> qi;
-
-	// check if already occupied
-	if (m_data(x, y) != Who::NONE)
-		return -1;
+	Int ind = x + board_Nx() * y, ret;
+	Bits dead;
+	Bits &mine = who == Who::BLACK ? m_black : m_white;
+	Bits &theirs = who == Who::BLACK ? m_white : m_black;
 
-	// place stone
-	m_data(x, y) = who;
-
-	// remove opponent's dead stones
-	// only necessary if placed next to opposite stone
-	if (x > 0 && m_data(x - 1, y) == next(who)) {
-		connect(mark, qi, group, x - 1, y);
-		if (qi.size() == 0) {
-			remove_group(group); removed = true;
-		}
-	}
-
-	if (y > 0 && m_data(x, y - 1) == next(who) && !mark(x, y - 1)) {
-		connect(mark, qi, group, x, y - 1);
-		if (qi.size() == 0) {
-			remove_group(group); removed = true;
-		}
-	}
-
-	if (x < Nx - 1 && m_data(x + 1, y) == next(who) && !mark(x + 1, y)) {
-		connect(mark, qi, group, x + 1, y);
-		if (qi.size() == 0) {
-			remove_group(group); removed = true;
-		}
-	}
-
-	if (y < Ny - 1 && m_data(x, y + 1) == next(who) && !mark(x, y + 1)) {
-		connect(mark, qi, group, x, y + 1);
-		if (qi.size() == 0) {
-			remove_group(group); removed = true;
-		}
-	}
-
-	if (removed) return 0;
-
-	// check qi of placed stone
-	connect(mark, qi, group, x, y);
-	if (qi.size() == 0) return -2;
+	ret = rules().place(mine, theirs, dead, ind);
+	if (ret < 0)
+		return ret;
 
+	// update hash
+	m_hash ^= zobrist(ind, who) ^ zobrist(dead, ::next(who));
 	return 0;
 }
 
 void Config::operator<<(Config_IO rhs)
 {
-	m_data << rhs.m_data;
-}
-
-inline void Config::connect(MatChar_O mark, vector<Move> &qi, vector<Move> /*_O*/ &group,
-	Char_I x, Char_I y, Who_I who_assume /*optional*/) const
-{
-	// init output
-	mark.resize(board_Nx(), board_Ny()); mark = 0; group.resize(0); qi.resize(0);
-	// connect (x,y) recursively
-	connect0(mark, qi, group, x, y, who_assume);
+	m_black = rhs.m_black; m_white = rhs.m_white;
+	m_hash = rhs.m_hash;
 }
 
-inline void Config::connect0(MatChar_IO mark, vector<Move> &qi, vector<Move> /*_IO*/ &group,
-	Char_I x, Char_I y, Who_I who_assume) const
+inline void Config::eat_list(vector<Move> &pos, Who_I who) const
 {
-	Char Nx = board_Nx(), Ny = board_Ny();
-	Who who, who0;
-	if (m_data(x, y) == Who::NONE) {
-		if (who_assume == Who::DEFAULT)
-			error("must specify who_assume argument!");
-		else
-			who0 = who_assume;
-	}
-	else
-		who0 = m_data(x, y);
-
-	group.push_back(Move(x, y));
-	mark(x, y) = 1;
-
-	if (x > 0) {
-		who = m_data(x - 1, y);
-		Char & rmark = mark(x - 1, y);
-		if (who == who0 && !rmark)
-			connect0(mark, qi, group, x - 1, y);
-		else if (who == Who::NONE && !rmark) {
-			qi.push_back(Move(x - 1, y)); rmark = 1;
+	Int i, j, ind, Ngroup, Ndead = 0, Nx = board_Nx();
+	Group groups[Ngroup_max], dead[Ngroup_max], group;
+
+	pos.resize(0);
+	Ngroup = all_groups(groups, ::next(who));
+	for (i = 0; i < Ngroup; ++i) {
+		if (groups[i].nqi() == 1) {
+			// insertion sort, more stones to remove first
+			group = groups[i];
+			for (j = Ndead; j > 0 && dead[j - 1].size() < group.size(); --j)
+				dead[j] = dead[j - 1];
+			dead[j] = group; ++Ndead;
 		}
 	}
 
-	if (x < Nx - 1) {
-		who = m_data(x + 1, y);
-		Char & rmark = mark(x + 1, y);
-		if (who == who0 && !rmark)
-			connect0(mark, qi, group, x + 1, y);
-		else if (who == Who::NONE && !rmark) {
-			qi.push_back(Move(x + 1, y)); rmark = 1;
-		}
+	for (i = 0; i < Ndead; ++i) {
+		ind = lowbit_ind(dead[i].qi());
+		pos.push_back(Move(ind % Nx, ind / Nx));
 	}
-
-	if (y > 0) {
-		who = m_data(x, y - 1);
-		Char & rmark = mark(x, y - 1);
-		if (who == who0 && !rmark)
-			connect0(mark, qi, group, x, y - 1);
-		else if (who == Who::NONE && !rmark) {
-			qi.push_back(Move(x, y - 1)); rmark = 1;
-		}
-	}
-
-	if (y < Ny - 1) {
-		who = m_data(x, y + 1);
-		Char & rmark = mark(x, y + 1);
-		if (who == who0 && !rmark)
-			connect0(mark, qi, group, x, y + 1);
-		else if (who == Who::NONE && !rmark) {
-			qi.push_back(Move(x, y + 1)); rmark = 1;
-		}
-	}
-}
-
-void Config::connect_qi(MatChar_O mark, vector<Move> /*_O*/ &group, Char_I x, Char_I y) const
-{
-	// init output
-	mark.resize(board_Nx(), board_Ny()); mark = Char(0); group.resize(0);
-	// connect (x,y) recursively
-	connect_qi0(mark, group, x, y);
 }
 
-void Config::connect_qi0(MatChar_IO mark, vector<Move> /*_IO*/ &group, Char_I x, Char_I y) const
+inline Int Config::all_groups(Group *groups, Who_I who) const
 {
-	Char Nx = board_Nx(), Ny = board_Ny(), x1, y1;
-
-	if (m_data(x, y) != Who::NONE)
-		error("(x,y) has a stone!");
-
-	group.push_back(Move(x, y));
-	mark(x, y) = 1;
-
-	if (x > 0) {
-		x1 = x - 1; y1 = y;
-		if (m_data(x1, y1) == Who::NONE && !mark(x1, y1)) {
-			connect_qi0(mark, group, x1, y1);
-		}
-	}
-
-	if (x < Nx - 1) {
-		x1 = x + 1; y1 = y;
-		if (m_data(x1, y1) == Who::NONE && !mark(x1, y1)) {
-			connect_qi0(mark, group, x1, y1);
-		}
-	}
-
-	if (y > 0) {
-		x1 = x; y1 = y - 1;
-		if (m_data(x1, y1) == Who::NONE && !mark(x1, y1)) {
-			connect_qi0(mark, group, x1, y1);
-		}
-	}
-
-	if (y < Ny - 1) {
-		x1 = x; y1 = y + 1;
-		if (m_data(x1, y1) == Who::NONE && !mark(x1, y1)) {
-			connect_qi0(mark, group, x1, y1);
-		}
-	}
+	Int Ngroup = 0;
+	Bits todo = stones(who), g;
+	Bits emp = empty();
+	while (todo) {
+		g = flood(lowbit(todo), todo);
+		todo &= ~g;
+		groups[Ngroup++] = Group(g, nbr(g) & emp);
+	}
+	return Ngroup;
 }
 
-inline void Config::remove_group(const vector<Move> &group)
+inline void Config::remove_group(Bits_I group)
 {
-	Int i;
-	for (i = 0; i < group.size(); ++i)
-		m_data(group[i].x(), group[i].y()) = Who::NONE;
+	m_hash ^= zobrist(group & m_black, Who::BLACK) ^ zobrist(group & m_white, Who::WHITE);
+	m_black &= ~group; m_white &= ~group;
 }
 
 Bool Config::is_game_end() const
 {
-	Char Nx = board_Nx(), Ny = board_Ny(), x, y;
-	Int qi, i;
-	MatChar tot_mark(Nx, Ny, Char(0)), mark;
-	vector<Move> group;
-
-	// scan all qi's on the board
-	for (y = 0; y < Ny; ++y) {
-		for (x = 0; x < Nx; ++x) {
-			if (m_data(x, y) != Who::NONE && !tot_mark(x, y))
-				continue;
-			connect_qi(mark, group, x, y);
-			qi = group.size();
-			for (i = 0; i < qi; ++i) {
-				tot_mark(group[i].x(), group[i].y()) = 1;
-			}
-			if (qi > 2)
-				return false;
-			else if (qi == 1) {
-				if (is_eye(x, y, Who::BLACK) || is_eye(x, y, Who::WHITE))
-					continue;
-				else
-					return false;
-			}
-			else if (qi == 2) {
-				if (is_dumb_2eye_filling(x, y, Who::BLACK) || is_dumb_2eye_filling(x, y, Who::WHITE))
-					return false;
-				cout << "warning: check mutual life for large board, ignore for now" << endl;
-				cout << "warning: check mutual life for large board, ignore for now" << endl;;
-				cout << "warning: check mutual life for large board, ignore for now" << endl;;
-				cout << "warning: check mutual life for large board, ignore for now" << endl;;
-				return false;
-			}
-		}
-	}
-	return true;
+	return rules().is_game_end(m_black, m_white);
 }
 
 inline Int Config::calc_territory2(Who_I who) const
 {
-	Char x, y, Nx = board_Nx(), Ny = board_Ny();
-	Int black = 0, qi = 0, common_qi = 0;
-	Who s;
-	for (x = 0; x < Nx; ++x)
-		for (y = 0; y < Ny; ++y) {
-			s = m_data(x, y);
-			if (s == Who::NONE) {
-				// qi not surrounded by black
-				if ((x > 0 && m_data(x - 1, y) != who)
-					|| (x < Nx - 1 && m_data(x + 1, y) != who)
-					|| (y > 0 && m_data(x, y - 1) != who)
-					|| (y < Ny - 1 && m_data(x, y + 1) != who)) {
-					// qi not surrounded by white
-					if ((x > 0 && m_data(x - 1, y) != next(who))
-						|| (x < Nx - 1 && m_data(x + 1, y) != next(who))
-						|| (y > 0 && m_data(x, y - 1) != next(who))
-						|| (y < Ny - 1 && m_data(x, y + 1) != next(who)))
-						++common_qi;
-				}
-				else // qi surrounded by black
-					++qi;
-			}
-			else if (s == who)
-				++black;
-			else if (s != next(who))
-				error("Config::result(): illegal stone!");
-		}
-	return 2 * (black + qi) + common_qi;
+	return rules().calc_territory2(stones(who), stones(::next(who)));
 }
 
 inline Bool Config::is_eye(Char_I x, Char_I y, Who_I who) const
 {
-	// check if already occupied
-	if (m_data(x, y) != Who::NONE)
-		return false;
-
-	// check if not surrounded by the same color or board
-	if (x > 0 && m_data(x - 1, y) != who ||
-		x < board_Nx() - 1 && m_data(x + 1, y) != who ||
-		y > 0 && m_data(x, y - 1) != who ||
-		y < board_Ny() - 1 && m_data(x, y + 1) != who)
-		return false;
-
-	return true;
+	// check if not occupied and surrounded by the same color or board
+	return (empty() & surrounded(stones(who)) & bit(x, y)) != 0;
 }
 
 inline Bool Config::is_dumb_eye_filling(Char_I x, Char_I y, Who_I who) const
 {
-	// not my eye 
-	if (!is_eye(x, y, who)) return false;
-
-	Int Nx = board_Nx(), Ny = board_Ny();
-
-	// output of connect()
-	MatChar mark(Nx, Ny); vector<Move> group; vector<Move> qi;
-
-	// check qi of sourrounding 4 stones
-	// if only 1 qi, it's not dumb
-
-	if (x > 0) {
-		connect(mark, qi, group, x - 1, y);
-		if (qi.size() == 1) return false;
-	}
-
-	if (y > 0 && !mark(x, y - 1)) {
-		connect(mark, qi, group, x, y - 1);
-		if (qi.size() == 1) return false;
-	}
-
-	if (x < Nx - 1 && !mark(x + 1, y)) {
-		connect(mark, qi, group, x + 1, y);
-		if (qi.size() == 1) return false;
-	}
-
-	if (y < Ny - 1 && !mark(x, y + 1)) {
-		connect(mark, qi, group, x, y + 1);
-		if (qi.size() == 1) return false;
-	}
-
-	// it is dumb...
-	return true;
+	return rules().is_dumb_eye_filling(stones(who), stones(::next(who)), x + board_Nx() * y);
 }
 
 inline Bool Config::is_dumb_2eye_filling(Char_I x, Char_I y, Who_I who) const
 {
-	Int Nx = board_Nx(), Ny = board_Ny();
-	Int black;
-	Char x1, y1, x_qi, y_qi;
-	Bool found_qi = false, connected = false;
-
-	// output of connect()
-	MatChar mark(Nx, Ny); vector<Move> group; vector<Move> qi;
-
-	// check qi of sourrounding 3 stones and one qi
-
-	// check left
-	x1 = x - 1; y1 = y;
-	if (x > 0) {
-		if (m_data(x1, y1) == who) {
-			if (connected) {
-				if (!mark(x1, y1)) return false; // black not connected
-			}
-			else {
-				connect(mark, qi, group, x1, y1);
-				connected = true;
-			}
-		}
-		else if (m_data(x1, y1) == Who::NONE) {
-			if (found_qi) return false; // more than one qi
-			found_qi = true; x_qi = x1; y_qi = y1;
-		}
-		else
-			return false; // found white stone
-	}
-
-	// check right
-	x1 = x + 1; y1 = y;
-	if (x < Nx - 1) {
-		if (m_data(x1, y1) == who) {
-			if (connected) {
-				if (!mark(x1, y1)) return false; // black not connected
-			}
-			else {
-				connect(mark, qi, group, x1, y1);
-				connected = true;
-			}
-		}
-		else if (m_data(x1, y1) == Who::NONE) {
-			if (found_qi) return false; // more than one qi
-			found_qi = true; x_qi = x1; y_qi = y1;
-		}
-		else
-			return false; // found white stone
-	}
-
-	// check up
-	x1 = x; y1 = y - 1;
-	if (y > 0) {
-		if (m_data(x1, y1) == who) {
-			if (connected) {
-				if (!mark(x1, y1)) return false; // black not connected
-			}
-			else {
-				connect(mark, qi, group, x1, y1);
-				connected = true;
-			}
-		}
-		else if (m_data(x1, y1) == Who::NONE) {
-			if (found_qi) return false; // more than one qi
-			found_qi = true; x_qi = x1; y_qi = y1;
-		}
-		else
-			return false; // found white stone
-	}
-
-	// check down
-	x1 = x; y1 = y + 1;
-	if (y < Ny - 1) {
-		if (m_data(x1, y1) == who) {
-			if (connected) {
-				if (!mark(x1, y1)) return false; // black not connected
-			}
-			else {
-				connect(mark, qi, group, x1, y1);
-				connected = true;
-			}
-		}
-		else if (m_data(x1, y1) == Who::NONE) {
-			if (found_qi) return false; // more than one qi
-			found_qi = true; x_qi = x1; y_qi = y1;
-		}
-		else
-			return false; // found white stone
-	}
-
-	// check the other qi
-
-	// left
-	x1 = x_qi - 1; y1 = y_qi;
-	if (x_qi > 0 && !(x1 == x && y1 == y)) {
-		if (!(m_data(x1, y1) == who && mark(x1, y1)))
-			return false;
-	}
-
-	// right
-	x1 = x_qi + 1; y1 = y_qi;
-	if (x_qi < Nx - 1 && !(x1 == x && y1 == y)) {
-		if (!(m_data(x1, y1) == who && mark(x1, y1)))
-			return false;
-	}
-
-	// up
-	x1 = x_qi; y1 = y_qi - 1;
-	if (y_qi > 0 && !(x1 == x && y1 == y)) {
-		if (!(m_data(x1, y1) == who && mark(x1, y1)))
-			return false;
-	}
-
-	// down
-	x1 = x_qi; y1 = y_qi + 1;
-	if (y_qi < Ny - 1 && !(x1 == x && y1 == y)) {
-		if (!(m_data(x1, y1) == who && mark(x1, y1)))
-			return false;
-	}
-
-	// ok, it is dumb...
-	return true;
+	return rules().is_dumb_2eye_filling(stones(who), stones(::next(who)), x + board_Nx() * y);
 }
 
 inline Int operator-(Config_I config1, Config_I config2)
 {
 	// rotation and inversion should make the board compare as big as possible
-	Char x, y;
-	Int Nx = board_Nx(), Ny = board_Ny(), N = Nx * Ny;
-	Int val1, val2;
-
-	for (y = 0; y < Ny; ++y) {
-		for (x = 0; x < Nx; ++x) {
-			val1 = who2int(config1(x, y));
-			val2 = who2int(config2(x, y));
-			if (val1 == val2) continue;
-			if (val1 > val2) return 1;
-			return -1;
-		}
-	}
-	return false;
+	// the first different point in row-major order decides
+	return compare_stones(config1.stones(Who::BLACK), config1.stones(Who::WHITE),
+		config2.stones(Who::BLACK), config2.stones(Who::WHITE));
 }
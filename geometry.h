@@ -0,0 +1,113 @@
+#pragma once
+#include "bitboard.h"
+
+// precomputed board symmetries, as permutations of bit indices
+// the stone at bit m_perm[i][ind] of the transformed board comes from bit ind of the original board
+// (same convention as Config::transform1())
+class SymTable
+{
+public:
+	Int m_Ntrans; // 8 for square board, 4 for rectangle board
+	Trans m_trans[8];
+	Char m_perm[8][64];
+	Char m_inv[8][64]; // inverse of m_perm
+	Char m_x[64], m_y[64]; // coordinates of each bit index
+
+	SymTable(Char_I Nx, Char_I Ny)
+	{
+		Int i;
+		Char x, y, x1, y1, xmax = Nx - 1, ymax = Ny - 1;
+		// same order as the old trial list in Config::calc_trans()
+		if (Nx == Ny) {
+			m_Ntrans = 8;
+			for (i = 0; i < 8; ++i)
+				m_trans[i] = Trans(i % 4, i >= 4);
+		}
+		else {
+			m_Ntrans = 4;
+			for (i = 0; i < 4; ++i)
+				m_trans[i] = Trans(2 * (i % 2), i >= 2);
+		}
+
+		for (i = 0; i < m_Ntrans; ++i) {
+			for (y = 0; y < Ny; ++y) {
+				for (x = 0; x < Nx; ++x) {
+					// (x1, y1) is the original point of (x, y) after transformation
+					switch (m_trans[i].rot()) {
+					case 0: x1 = x; y1 = y; break;
+					case 1: x1 = ymax - y; y1 = x; break;
+					case 2: x1 = xmax - x; y1 = ymax - y; break;
+					default: x1 = y; y1 = xmax - x;
+					}
+					m_perm[i][x1 + Nx * y1] = x + Nx * y;
+					m_inv[i][x + Nx * y] = x1 + Nx * y1;
+				}
+			}
+		}
+		for (y = 0; y < Ny; ++y) {
+			for (x = 0; x < Nx; ++x) {
+				m_x[x + Nx * y] = x; m_y[x + Nx * y] = y;
+			}
+		}
+	}
+
+	// index of a transformation in m_trans
+	Int index(Trans_I trans) const
+	{
+#ifdef GOS_CHECK_BOUND
+		if (m_Ntrans == 4 && trans.rot() % 2)
+			error("illegal rotation for rectangle board!");
+#endif
+		if (m_Ntrans == 8)
+			return trans.rot() + 4 * trans.flip();
+		return trans.rot() / 2 + 2 * trans.flip();
+	}
+
+	// permute the bits of b with the i-th transformation (stone color not flipped)
+	Bits permute(Bits_I b, Int_I i) const
+	{
+		Bits out = 0;
+		for (Bits b1 = b; b1; b1 &= b1 - 1)
+			out |= Bits(1) << m_perm[i][lowbit_ind(b1)];
+		return out;
+	}
+};
+
+// symmetry table of the board, built on first use (board size must be set before)
+inline const SymTable & sym_table()
+{
+	static const SymTable table(board_Nx(), board_Ny());
+	return table;
+}
+
+// transform coordinates
+inline void transf(Char_IO x, Char_IO y, Int_I rot)
+{
+	const SymTable &sym = sym_table();
+	Int ind = sym.m_perm[sym.index(Trans(rot, false))][x + board_Nx() * y];
+	x = sym.m_x[ind]; y = sym.m_y[ind];
+}
+
+// transform coordinates and who
+inline void transf(Char_IO x, Char_IO y, Who_O who, Trans_I trans)
+{
+	transf(x, y, trans.rot());
+	if (trans.flip())
+		who = next(who);
+}
+
+// inverse transform coordinates
+inline void inv_transf(Char_IO x, Char_IO y, Int_I rot)
+{
+	const SymTable &sym = sym_table();
+	Int ind = sym.m_inv[sym.index(Trans(rot, false))][x + board_Nx() * y];
+	x = sym.m_x[ind]; y = sym.m_y[ind];
+}
+
+// inverse transform coordinates and who
+inline void inv_transf(Char_IO x, Char_IO y, Who_O who, Trans_I trans)
+{
+	inv_transf(x, y, trans.rot());
+	if (trans.flip())
+		who = next(who);
+}
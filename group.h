@@ -1,26 +1,37 @@
 #pragma once
-#include "move.h"
+#include "bitboard.h"
 
 // a group of connected stones
 class Group
 {
 private:
-	vector<Move> m_pos;
-	vector<Move> m_qi;
+	Bits m_pos; // stones
+	Bits m_qi;
 public:
+	Group() {}
+	Group(Bits_I pos, Bits_I qi) : m_pos(pos), m_qi(qi) {}
+
 	// === constant functions ===
-	const vector<Move> & qi() const
+	Bits pos() const
 	{
-		return m_qi;
+		return m_pos;
 	}
 
-	vector<Move> & qi()
+	Bits qi() const
 	{
 		return m_qi;
 	}
 
-	vector<Move> & pos()
+	Int size() const
 	{
-		return m_pos;
+		return popcount(m_pos);
+	}
+
+	Int nqi() const
+	{
+		return popcount(m_qi);
 	}
 };
+
+// max number of groups of one player (no two groups of the same player are adjacent)
+const Int Ngroup_max = 32;
@@ -0,0 +1,206 @@
+#pragma once
+#include "config.h"
+
+// all groups of a configuration and their qi's
+// built with build(), then every candidate move is checked against the adjacent groups only
+// place() updates the affected groups only (merged, captured, or lost a qi), e.g. for a depth first search (see perft.h)
+// a group is identified by its root, the bit index of one of its stones
+class GroupTable
+{
+private:
+	Bits m_black, m_white; // stones
+	Char m_root[64]; // root of the group of each stone, -1 for empty points
+	Bits m_group[64]; // stones of a group, only valid for roots
+	Bits m_qi[64]; // qi's of a group, only valid for roots
+
+public:
+	GroupTable() {}
+
+	// === const functions ===
+
+	Bits stones(Who_I who) const;
+
+	Bits empty() const;
+
+	// same as Config::check(), only adjacent groups are checked
+	Int check(Char_I x, Char_I y, Who_I who) const;
+
+	// same as Config::is_dumb_eye_filling(), without flood fill
+	Bool is_dumb_eye_filling(Char_I x, Char_I y, Who_I who) const;
+
+	// same as Config::eat_list(), larger dead groups first
+	void eat_list(vector<Move> &pos, Who_I who) const;
+
+	// === none-const functions ===
+
+	// find all groups of a configuration
+	void build(Config_I config);
+
+	// same as Config::place(), update affected groups only
+	Int place(Char_I x, Char_I y, Who_I who);
+};
+
+inline Bits GroupTable::stones(Who_I who) const
+{
+	if (who == Who::BLACK)
+		return m_black;
+	else if (who == Who::WHITE)
+		return m_white;
+	error("illegal who!");
+	return 0;
+}
+
+inline Bits GroupTable::empty() const
+{
+	return bit_geom().m_board & ~(m_black | m_white);
+}
+
+inline Int GroupTable::check(Char_I x, Char_I y, Who_I who) const
+{
+	Bits b = bit(x, y), theirs = stones(::next(who)), adj, dead = 0, qi;
+	Int r;
+
+	// check if already occupied
+	if (!(empty() & b))
+		return -1;
+
+	// qi's of the new stone and of the groups it connects to
+	adj = nbr(b);
+	qi = adj & empty();
+	for (adj &= m_black | m_white; adj; adj &= ~m_group[r]) {
+		r = m_root[lowbit_ind(adj)];
+		if (m_group[r] & theirs) {
+			if (m_qi[r] == b)
+				dead |= m_group[r]; // (x,y) is the last qi
+		}
+		else
+			qi |= m_qi[r];
+	}
+
+	if (dead)
+		return popcount(dead);
+
+	if (!(qi & ~b))
+		return -2;
+
+	return 0;
+}
+
+inline Bool GroupTable::is_dumb_eye_filling(Char_I x, Char_I y, Who_I who) const
+{
+	Bits b = bit(x, y), adj;
+	Int r;
+
+	// not my eye
+	if (!(empty() & surrounded(stones(who)) & b))
+		return false;
+
+	// if a surrounding group only has 1 qi, it's not dumb
+	for (adj = nbr(b); adj; adj &= ~m_group[r]) {
+		r = m_root[lowbit_ind(adj)];
+		if (m_qi[r] == b)
+			return false;
+	}
+
+	// it is dumb...
+	return true;
+}
+
+inline void GroupTable::eat_list(vector<Move> &pos, Who_I who) const
+{
+	Int i, j, r, Ndead = 0, Nx = board_Nx();
+	Bits theirs = stones(::next(who));
+	Int dead_roots[Ngroup_max];
+
+	pos.resize(0);
+	for (; theirs; theirs &= ~m_group[r]) {
+		r = m_root[lowbit_ind(theirs)];
+		if (popcount(m_qi[r]) == 1) {
+			// insertion sort, more stones to remove first
+			for (j = Ndead; j > 0 && popcount(m_group[dead_roots[j - 1]]) < popcount(m_group[r]); --j)
+				dead_roots[j] = dead_roots[j - 1];
+			dead_roots[j] = r; ++Ndead;
+		}
+	}
+
+	for (i = 0; i < Ndead; ++i) {
+		r = lowbit_ind(m_qi[dead_roots[i]]);
+		pos.push_back(Move(r % Nx, r / Nx));
+	}
+}
+
+inline void GroupTable::build(Config_I config)
+{
+	Int i, r;
+	Bits emp = config.empty(), todo, g, b;
+	m_black = config.stones(Who::BLACK);
+	m_white = config.stones(Who::WHITE);
+	for (i = 0; i < 64; ++i)
+		m_root[i] = -1;
+	for (i = 0; i < 2; ++i) {
+		todo = i == 0 ? m_black : m_white;
+		while (todo) {
+			g = flood(lowbit(todo), todo);
+			todo &= ~g;
+			r = lowbit_ind(g);
+			m_group[r] = g;
+			m_qi[r] = nbr(g) & emp;
+			for (b = g; b; b &= b - 1)
+				m_root[lowbit_ind(b)] = r;
+		}
+	}
+}
+
+inline Int GroupTable::place(Char_I x, Char_I y, Who_I who)
+{
+	Bits b = bit(x, y), adj, dead = 0, g = b, qi, s;
+	Bits &mine = who == Who::BLACK ? m_black : m_white;
+	Bits &theirs = who == Who::BLACK ? m_white : m_black;
+	Int r;
+
+	// check if already occupied
+	if (!(empty() & b))
+		return -1;
+
+	// groups to merge and groups to remove
+	adj = nbr(b);
+	qi = adj & empty();
+	for (s = adj & (mine | theirs); s; s &= ~m_group[r]) {
+		r = m_root[lowbit_ind(s)];
+		if (m_group[r] & theirs) {
+			if (m_qi[r] == b)
+				dead |= m_group[r];
+		}
+		else {
+			g |= m_group[r]; qi |= m_qi[r];
+		}
+	}
+	qi &= ~b;
+
+	// suicide, do nothing
+	if (!dead && !qi)
+		return -2;
+
+	// place stone and merge groups
+	mine |= b;
+	for (s = adj & theirs & ~dead; s; s &= ~m_group[r]) {
+		r = m_root[lowbit_ind(s)];
+		m_qi[r] &= ~b;
+	}
+	r = lowbit_ind(g);
+	m_group[r] = g; m_qi[r] = qi;
+	for (s = g; s; s &= s - 1)
+		m_root[lowbit_ind(s)] = r;
+
+	// remove dead groups, their stones become qi's of adjacent groups
+	if (dead) {
+		theirs &= ~dead;
+		for (s = dead; s; s &= s - 1)
+			m_root[lowbit_ind(s)] = -1;
+		for (s = nbr(dead) & mine; s; s &= ~m_group[r]) {
+			r = m_root[lowbit_ind(s)];
+			m_qi[r] |= nbr(m_group[r]) & dead;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,141 @@
+#pragma once
+#include "common.h"
+#include "checkpoint.h"
+
+// hash table of records with Ullong keys, O(1) find, insert and remove
+// records are stored densely for cheap iteration, remove() moves the last record into the gap
+// m_table is an open addressing hash table (linear probing) of record indices, -1 for empty slot, size is a power of 2
+template <class T>
+class Registry
+{
+private:
+	vector<Ullong> m_keys; // key of each record
+	vector<T> m_recs;
+	vector<Int> m_table;
+
+	// spread the bits of a key (tree indices are small)
+	static Ullong mix(Ullong key)
+	{
+		key ^= key >> 33; key *= 0xff51afd7ed558ccdULL;
+		key ^= key >> 33;
+		return key;
+	}
+
+	Long home(Ullong_I key) const { return mix(key) & (m_table.size() - 1); }
+
+	// slot of a key, or the empty slot where it should be inserted
+	Long find_slot(Ullong_I key) const
+	{
+		Long mask = m_table.size() - 1, slot = home(key);
+		while (m_table[slot] >= 0 && m_keys[m_table[slot]] != key)
+			slot = (slot + 1) & mask;
+		return slot;
+	}
+
+	// rebuild m_table with a new size (power of 2)
+	void rehash(Long_I Nslot)
+	{
+		m_table.assign(Nslot, -1);
+		for (Int i = 0; i < (Int)m_recs.size(); ++i)
+			m_table[find_slot(m_keys[i])] = i;
+	}
+
+public:
+	Registry() : m_table(16, -1) {}
+
+	Int size() const { return m_recs.size(); }
+
+	// the i-th record (for iteration, 0 <= i < size())
+	T & operator[](Int_I i) { return m_recs[i]; }
+	const T & operator[](Int_I i) const { return m_recs[i]; }
+
+	Ullong key(Int_I i) const { return m_keys[i]; }
+
+	// return the index of a record, -1 if not found
+	Int find(Ullong_I key) const
+	{
+		return m_table[find_slot(key)];
+	}
+
+	// add a record, or replace the record of the same key
+	// return the index of the record
+	Int insert(Ullong_I key, const T &rec)
+	{
+		Long slot = find_slot(key);
+		if (m_table[slot] >= 0) {
+			m_recs[m_table[slot]] = rec;
+			return m_table[slot];
+		}
+		// keep load factor below 1/2
+		if (2 * (m_recs.size() + 1) > m_table.size()) {
+			rehash(2 * m_table.size());
+			slot = find_slot(key);
+		}
+		m_keys.push_back(key); m_recs.push_back(rec);
+		m_table[slot] = m_recs.size() - 1;
+		return m_table[slot];
+	}
+
+	// remove a record
+	// return false if not found
+	Bool remove(Ullong_I key)
+	{
+		Long mask = m_table.size() - 1, slot = find_slot(key), j, k;
+		Int ind = m_table[slot], last = m_recs.size() - 1;
+		if (ind < 0)
+			return false;
+
+		// delete the slot, shift back the following slots so that probing still works
+		for (j = slot; ; ) {
+			j = (j + 1) & mask;
+			if (m_table[j] < 0)
+				break;
+			k = home(m_keys[m_table[j]]);
+			// move if home position k is not cyclically in (slot, j]
+			if (slot <= j ? (k <= slot || k > j) : (k <= slot && k > j)) {
+				m_table[slot] = m_table[j]; slot = j;
+			}
+		}
+		m_table[slot] = -1;
+
+		// move the last record into the gap
+		if (ind != last) {
+			m_table[find_slot(m_keys[last])] = ind;
+			m_keys[ind] = m_keys[last]; m_recs[ind] = m_recs[last];
+		}
+		m_keys.pop_back(); m_recs.pop_back();
+		return true;
+	}
+
+	void clear()
+	{
+		m_keys.clear(); m_recs.clear();
+		m_table.assign(16, -1);
+	}
+
+	// write all records, converted by 'f' (e.g. pointers to indices)
+	template <class F>
+	void save(CkptWriter &out, F f) const
+	{
+		out.write(m_keys);
+		out.write(m_recs.data(), m_recs.size(), f);
+		out.write(m_table);
+	}
+
+	// read records written by save(), converted back by 'f'
+	template <class F>
+	void load(CkptReader &in, F f)
+	{
+		in.read(m_keys); in.read(m_recs); in.read(m_table);
+		for (Int i = 0; i < (Int)m_recs.size(); ++i)
+			m_recs[i] = f(m_recs[i]);
+	}
+};
+
+// record of a clean ko node, saved when it is found clean
+class CleanKoNode
+{
+public:
+	Int m_sco2; // don't trust Tree::score2() of a clean ko node
+	Sol m_sol;
+};
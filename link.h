@@ -1,5 +1,8 @@
 #pragma once
+#include <memory>
+#include <algorithm>
 #include "move.h"
+#include "checkpoint.h"
 
 enum class LnType : Char
 {
@@ -43,114 +46,152 @@ inline LnType rm_trans(LnType_I type)
 		return LnType::KO_S;
 }
 
-// short link
-class Link : public Move
+// short link, packed in 8 bytes
+// bits 0-24: from + 1, bits 25-49: to + 1, bits 50-52: type, bit 53: resolved,
+// bits 54-55: rotation, bit 56: flip, bits 57-63: move (see move2code())
+class Link
 {
 protected:
-	// basic members
-	LnType m_type; // link type
-	Long m_from; // tree index of source node
-	Long m_to; // tree index of target node
+	Ullong m_code;
 
-	// other members
-	Trans m_trans; // transformation
-	Bool m_reso; // if ko links is resolved
+	static const Long Nnode_max = (1 << 25) - 1; // tree indices must be less than this
+
+	static const Int sh_to = 25, sh_type = 50, sh_reso = 53, sh_rot = 54, sh_flip = 56, sh_move = 57;
+
+	// move code: x + Nx*y for placing, 127 for pass, 126 for edit, 125 for init, 124 for end
+	static Ullong move2code(Move_I move)
+	{
+		if (move.isplace())
+			return move.x() + board_Nx() * move.y();
+		else if (move.ispass())
+			return 127;
+		else if (move.isedit())
+			return 126;
+		error("illegal move for a link!");
+		return 0;
+	}
+
+	Ullong field(Int_I shift, Int_I nbit) const { return (m_code >> shift) & ((Ullong(1) << nbit) - 1); }
+
+	void set_field(Int_I shift, Int_I nbit, Ullong_I val)
+	{
+		Ullong mask = ((Ullong(1) << nbit) - 1) << shift;
+		m_code = (m_code & ~mask) | (val << shift & mask);
+	}
+
+	void set(LnType_I type, Long_I from, Long_I to, Ullong_I move_code)
+	{
+		if (from >= Nnode_max || to >= Nnode_max)
+			error("too many nodes for Link!");
+		m_code = Ullong(from + 1) | Ullong(to + 1) << sh_to | Ullong(type) << sh_type | move_code << sh_move;
+	}
+
+	void set_type(LnType_I type) { set_field(sh_type, 3, Ullong(type)); }
+
+	void set_reso(Bool_I reso) { set_field(sh_reso, 1, reso); }
+
+	friend class LinkArena;
 
 public:
 
-	Link(): m_reso(false) {}
+	Link(): m_code(0) {}
+
+	LnType type() const { return LnType(field(sh_type, 3)); }
+	Long from() const { return Long(field(0, 25)) - 1; }
+	Long to() const { return Long(field(sh_to, 25)) - 1; }
+	Move move() const
+	{
+		Int code = field(sh_move, 7);
+		if (code < 124)
+			return Move(code % board_Nx(), code / board_Nx());
+		return Move(code == 127 ? Act::PASS : code == 126 ? Act::EDIT : code == 125 ? Act::INIT : Act::END);
+	}
+	Bool isinit() const { return type() == LnType::INIT; }
+	Bool isend() const { return type() == LnType::END; }
+	Bool isko() const { return ::isko(type()); }
+	Bool istrans() const { return ::istrans(type()); }
 
-	const LnType &type() const { return m_type; }
-	const Long &from() const { return m_from; }
-	const Long &to() const { return m_to; }
-	const Move &move() const { return *this; }
-	const Bool isinit() const { return m_type == LnType::INIT; }
-	const Bool isend() const { return m_type == LnType::END; }
-	const Bool isko() const { return ::isko(m_type); }
-	const Bool istrans() const { return ::istrans(m_type); }
+	// key of a link (e.g. in a Registry): from, to, move and trans, not the type or the resolved bit
+	// unique among the links of a tree, and does not change when a ko link is shifted
+	Ullong key() const { return m_code & ~(Ullong(0xF) << sh_type); }
+
+	// move related, same as Move
+	Bool ispass() const { return field(sh_move, 7) == 127; }
+	Bool isedit() const { return field(sh_move, 7) == 126; }
+	Char x() const { return move().x(); }
+	Char y() const { return move().y(); }
 	
 	void link(LnType_I type, Long_I from, Long_I to, Move_I move)
 	{
 		if (::istrans(type))
 			error("not a simple link!");
-		m_type = type;
-		m_from = from;
-		m_to = to;
-		Move::operator=(move);
+		set(type, from, to, move2code(move));
 	}
 
 	void link(LnType_I type, Long_I from, Long_I to, Move_I move, Trans_I trans)
 	{
 		if (!::istrans(type))
 			error("not a trans link!");
-		m_type = type;
-		m_from = from;
-		m_to = to;
-		m_trans = trans;
-		Move::operator=(move);
+		set(type, from, to, move2code(move));
+		set_field(sh_rot, 2, trans.rot());
+		set_field(sh_flip, 1, trans.flip());
 	}
 
 	void init()
 	{
-		m_type = LnType::INIT;
-		m_from = -1;
-		m_to = 0;
-		Move::init();
+		set(LnType::INIT, -1, 0, 125);
 	}
 
 	void end(Long_I treeInd)
 	{
-		m_type = LnType::INIT;
-		m_from = treeInd;
-		m_to = -1;
-		Move::end();
+		set(LnType::INIT, treeInd, -1, 124);
 	}
 
-	const Trans &trans() const
+	Trans trans() const
 	{
-		if (!::istrans(m_type))
+		if (!istrans())
 			error("not a trans link!");
-		return m_trans;
+		return Trans(field(sh_rot, 2), field(sh_flip, 1));
 	}
 	
 	Bool resolved() const
 	{
-		if (!::isko(m_type))
+		if (!isko())
 			error("not a ko link!");
-		return m_reso;
+		return field(sh_reso, 1);
 	}
 	
 	void resolve()
 	{
-		if (!::isko(m_type))
+		if (!isko())
 			error("not a ko link!");
-		m_reso = true;
+		set_reso(true);
 	}
 
 	// only support ko/non-ko conversion for now
 	void convert(LnType_I type)
 	{
-		if (::isko(m_type)) {
+		if (isko()) {
 			// from ko link
 			if (!::isko(type)) {
 				// to non-ko link
-				if (m_type == LnType::KO_S) {
-					m_type = LnType::SIMPLE;
+				if (this->type() == LnType::KO_S) {
+					set_type(LnType::SIMPLE);
 				}
-				else { // m_type == LnType::KO_T
-					m_type = LnType::TRANS;
+				else { // type() == LnType::KO_T
+					set_type(LnType::TRANS);
 				}
 			}
 		}
 		else {
 			// from non-ko link
-			if (::istrans(m_type)) {
+			if (istrans()) {
 				// to ko link
-				if (m_type == LnType::SIMPLE) {
-					m_type = LnType::KO_S;
+				if (this->type() == LnType::SIMPLE) {
+					set_type(LnType::KO_S);
 				}
-				else { // m_type == LnType::TRANS
-					m_type = LnType::KO_T;
+				else { // type() == LnType::TRANS
+					set_type(LnType::KO_T);
 				}
 			}
 		}
@@ -159,13 +200,13 @@ public:
 
 	void ko_link_2_link()
 	{
-		if (m_type == LnType::KO_S) {
-			m_type = LnType::SIMPLE;
-			m_reso = false;
+		if (type() == LnType::KO_S) {
+			set_type(LnType::SIMPLE);
+			set_reso(false);
 		}
-		else if (m_type == LnType::KO_T) {
-			m_type = LnType::TRANS;
-			m_reso = false;
+		else if (type() == LnType::KO_T) {
+			set_type(LnType::TRANS);
+			set_reso(false);
 		}
 		else
 			error("not a ko link");
@@ -173,52 +214,170 @@ public:
 
 	void link_2_ko_link()
 	{
-		if (m_type == LnType::SIMPLE) {
-			m_type = LnType::KO_S;
-			m_reso = false;
+		if (type() == LnType::SIMPLE) {
+			set_type(LnType::KO_S);
+			set_reso(false);
 		}
-		else if (m_type == LnType::TRANS) {
-			m_type = LnType::KO_T;
-			m_reso = false;
+		else if (type() == LnType::TRANS) {
+			set_type(LnType::KO_T);
+			set_reso(false);
 		}
 		else
 			error("not a ko link");
 	}
 };
 
+// pointer to a link in a LinkArena
 class Linkp
 {
 protected:
-	// index for Link::m_links
-	Long m_linkInd;
-
-	// all links stored here
-	static vector<Link> m_links;
+	Link *m_plink;
 
 public:
 
-	Linkp() : m_linkInd(-1) {}
+	Linkp() : m_plink(nullptr) {}
 
-	Linkp(Long_I linkInd) : m_linkInd(linkInd) {} // allow Linkp = Long conversion
+	Linkp(Link *plink) : m_plink(plink) {}
 
-	// create new un-initialized link and return pointer
-	static Linkp newlink()
-	{
-		m_links.emplace_back();
-		return Linkp(m_links.size() - 1);
-	}
+	Bool isnull() const { return m_plink == nullptr; }
 
 	Link* operator->() const
 	{
-		return &m_links[m_linkInd];
+		return m_plink;
 	}
 
 	friend Bool operator==(Linkp_I lhs, Linkp_I rhs);
+	friend class LinkArena;
 };
 
-
+// a Linkp holding a link index of a checkpoint instead of a pointer (see LinkArena::encode())
+inline Linkp ckpt_linkp(Ullong_I code) { return Linkp((Link *)code); }
 
 inline Bool operator==(Linkp_I lhs, Linkp_I rhs)
 {
-	return lhs.m_linkInd == rhs.m_linkInd;
+	return lhs.m_plink == rhs.m_plink;
 }
+
+// all links of a Tree
+// links are allocated in chunks that never move, so a Linkp stays valid as the arena grows
+// freed links are kept in a list (through Link::m_code) and reused first
+class LinkArena
+{
+private:
+	static const Int Nchunk_bit = 12; // links per chunk
+
+	vector<std::unique_ptr<Link[]>> m_chunks;
+	Long m_Nalloc; // links allocated from chunks
+	Link *m_free; // first freed link
+	Long m_Nfree; // number of freed links
+	vector<std::pair<const Link *, Long>> m_sorted; // chunks sorted by address, for encode()
+
+public:
+	LinkArena() : m_Nalloc(0), m_free(nullptr), m_Nfree(0) {}
+
+	LinkArena(const LinkArena &) = delete;
+	LinkArena & operator=(const LinkArena &) = delete;
+
+	// number of links in use
+	Long size() const { return m_Nalloc - m_Nfree; }
+
+	// create new un-initialized link and return pointer
+	Linkp alloc()
+	{
+		if (m_free) {
+			Link *plink = m_free;
+			m_free = (Link *)plink->m_code;
+			--m_Nfree;
+			plink->m_code = 0;
+			return Linkp(plink);
+		}
+		if ((m_Nalloc >> Nchunk_bit) == (Long)m_chunks.size())
+			m_chunks.emplace_back(new Link[1 << Nchunk_bit]);
+		Link *plink = &m_chunks.back()[m_Nalloc & ((1 << Nchunk_bit) - 1)];
+		++m_Nalloc;
+		return Linkp(plink);
+	}
+
+	// free a link, it must not be used by any node
+	void free(Linkp_I plink)
+	{
+		plink.m_plink->m_code = (Ullong)m_free;
+		m_free = plink.m_plink;
+		++m_Nfree;
+	}
+
+	// === checkpoint ===
+
+	// sort the chunks for encode(), call after the last alloc()
+	void prepare_encode()
+	{
+		m_sorted.resize(m_chunks.size());
+		for (Long i = 0; i < (Long)m_chunks.size(); ++i)
+			m_sorted[i] = std::make_pair((const Link *)m_chunks[i].get(), i);
+		std::sort(m_sorted.begin(), m_sorted.end());
+	}
+
+	// 1 + index of a link, 0 for null
+	Ullong encode(const Link *plink) const
+	{
+		if (!plink)
+			return 0;
+		auto it = std::upper_bound(m_sorted.begin(), m_sorted.end(), std::make_pair(plink, Long(1) << 62)) - 1;
+		return ((it->second << Nchunk_bit) | (plink - it->first)) + 1;
+	}
+
+	Linkp encode(Linkp_I plink) const { return ckpt_linkp(encode(plink.m_plink)); }
+
+	// inverse of encode()
+	Link *decode(Ullong_I code) const
+	{
+		if (code == 0)
+			return nullptr;
+		return &m_chunks[(code - 1) >> Nchunk_bit][(code - 1) & ((1 << Nchunk_bit) - 1)];
+	}
+
+	Linkp decode(Linkp_I plink) const { return Linkp(decode((Ullong)plink.m_plink)); }
+
+	// write all links, the free list is written as link indices
+	void save(CkptWriter &out)
+	{
+		prepare_encode();
+		out.write(m_Nalloc); out.write(m_Nfree); out.write(encode(m_free));
+		vector<Ullong> codes(1 << Nchunk_bit);
+		for (Long i = 0; i < (Long)m_chunks.size(); ++i) {
+			Long n = MIN(Long(1) << Nchunk_bit, m_Nalloc - (i << Nchunk_bit));
+			for (Long j = 0; j < n; ++j)
+				codes[j] = m_chunks[i][j].m_code;
+			out.write(codes.data(), n);
+		}
+		// free links hold the next free link
+		vector<Ullong> next;
+		for (Link *p = m_free; p; p = (Link *)p->m_code)
+			next.push_back(encode((Link *)p->m_code));
+		out.write(next);
+	}
+
+	void load(CkptReader &in)
+	{
+		Long i, j, n;
+		Ullong free_code;
+		in.read(m_Nalloc); in.read(m_Nfree); in.read(free_code);
+		m_chunks.clear();
+		for (i = 0; (i << Nchunk_bit) < m_Nalloc; ++i) {
+			const Ullong *codes = in.read_array<Ullong>(n);
+			m_chunks.emplace_back(new Link[1 << Nchunk_bit]);
+			for (j = 0; j < n; ++j)
+				m_chunks[i][j].m_code = codes[j];
+		}
+		vector<Ullong> next;
+		in.read(next);
+		if ((Long)next.size() != m_Nfree)
+			error("checkpoint: wrong free links!");
+		m_free = decode(free_code);
+		Link *p = m_free;
+		for (j = 0; j < m_Nfree; ++j) {
+			p->m_code = (Ullong)decode(next[j]);
+			p = (Link *)p->m_code;
+		}
+	}
+};
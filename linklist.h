@@ -0,0 +1,128 @@
+#pragma once
+#include "link.h"
+
+// storage of the overflow blocks of all LinkList of a NodeStore
+// a block of class k has capacity 4 << k, freed blocks are reused for the same class
+// blocks are addressed by offset, so m_data can grow
+class LinkBlocks
+{
+public:
+	static const Int Ncls = 24;
+
+	vector<Linkp> m_data;
+	vector<Long> m_free[Ncls]; // offsets of free blocks of each class
+
+	static Long capacity(Int_I cls) { return Long(4) << cls; }
+
+	// allocate a block, return the offset
+	Long alloc(Int_I cls)
+	{
+		Long ind;
+		if (cls >= Ncls)
+			error("LinkBlocks: block too large!");
+		if (!m_free[cls].empty()) {
+			ind = m_free[cls].back();
+			m_free[cls].pop_back();
+			return ind;
+		}
+		ind = m_data.size();
+		m_data.resize(ind + capacity(cls));
+		return ind;
+	}
+
+	void free(Long_I ind, Int_I cls)
+	{
+		m_free[cls].push_back(ind);
+	}
+};
+
+// list of links of a node (parents or children)
+// the first Ninline links are stored inline, the rest in a block of LinkBlocks
+template <Int Ninline>
+class LinkList
+{
+private:
+	Linkp m_inline[Ninline];
+	Int m_size;
+	Int m_block; // offset of the overflow block in LinkBlocks::m_data
+	Char m_cls; // class of the overflow block, -1 if none
+
+public:
+	LinkList() : m_size(0), m_block(0), m_cls(-1) {}
+
+	Int size() const { return m_size; }
+
+	Linkp get(Int_I i, const LinkBlocks &blocks) const
+	{
+		return i < Ninline ? m_inline[i] : blocks.m_data[m_block + i - Ninline];
+	}
+
+	void set(Int_I i, Linkp_I plink, LinkBlocks &blocks)
+	{
+		if (i < Ninline)
+			m_inline[i] = plink;
+		else
+			blocks.m_data[m_block + i - Ninline] = plink;
+	}
+
+	void push_back(Linkp_I plink, LinkBlocks &blocks)
+	{
+		Long n = m_size - Ninline; // number of overflow links
+		if (n >= 0) {
+			if (m_cls < 0) {
+				m_cls = 0;
+				m_block = blocks.alloc(m_cls);
+			}
+			else if (n == LinkBlocks::capacity(m_cls)) {
+				// move to a larger block
+				Long block = blocks.alloc(m_cls + 1);
+				for (Long i = 0; i < n; ++i)
+					blocks.m_data[block + i] = blocks.m_data[m_block + i];
+				blocks.free(m_block, m_cls);
+				m_block = block; ++m_cls;
+			}
+		}
+		++m_size;
+		set(m_size - 1, plink, blocks);
+	}
+
+	void pop_back(LinkBlocks &blocks)
+	{
+		--m_size;
+		if (m_size == Ninline && m_cls >= 0) {
+			blocks.free(m_block, m_cls);
+			m_cls = -1;
+		}
+	}
+
+	// remove a link, keep the order of others
+	void erase(Int_I i, LinkBlocks &blocks)
+	{
+		for (Int j = i + 1; j < m_size; ++j)
+			set(j - 1, get(j, blocks), blocks);
+		pop_back(blocks);
+	}
+
+	// remove a link in O(1), the last link takes its place
+	void swap_erase(Int_I i, LinkBlocks &blocks)
+	{
+		set(i, get(m_size - 1, blocks), blocks);
+		pop_back(blocks);
+	}
+
+	void clear(LinkBlocks &blocks)
+	{
+		while (m_size > 0)
+			pop_back(blocks);
+	}
+
+	// a copy with the inline links converted by 'f' (see LinkArena::encode() and decode())
+	template <class F>
+	LinkList map(F f) const
+	{
+		LinkList list = *this;
+		for (Int i = 0; i < MIN(m_size, Ninline); ++i)
+			list.m_inline[i] = f(m_inline[i]);
+		return list;
+	}
+};
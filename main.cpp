@@ -1,15 +1,30 @@
 //#include "ui.h"
-#include "tree.h"
+#include "batch.h"
 
-// static member definitions
-vector<Link> Linkp::m_links;
+// usage:
+//   go                 solve 3x3 with prompts (edit the board below)
+//   go [options]       solve without prompts
+//     --size Nx Ny     board size (default 3 3)
+//     --komi k         komi, e.g. 8.5 (default)
+//     --moves "bb bc"  start from these moves, SGF coordinates separated by spaces (default empty board)
+//     --out file       output SGF file (default test.sgf)
+//     --log n          0: quiet, 1: progress every interval (default), 2: also display every new node
+//     --progress file  write progress to a file instead of stderr
+//     --interval t     seconds between progress lines (default 1)
+//     --checkpoint file  write a checkpoint every --checkpoint-interval seconds, on SIGUSR1, and on SIGINT (then exit)
+//     --checkpoint-interval t  (default 600)
+//     --restore file   continue from a checkpoint, board size and komi are read from it
+//   exit codes: 0 solved, 1 illegal input, 2 error of the solver, 130 interrupted
 
-int main()
+int main(int argc, char *argv[])
 {
 	// computer_vs_computer_ui();
 	// human_vs_computer_ui();
 	// human_vs_human_ui();
 
+	if (argc > 1)
+		return batch_solve(argc, argv);
+
 	board_Nx(3); board_Ny(3); // set board size
 	komi2(17); // set koomi
 	Tree tree;
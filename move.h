@@ -18,7 +18,8 @@ private:
 public:
 	// === constructors ===
 	Move() {}
-	Move(const Move &mov) { m_x = mov.m_x; m_y = mov.m_y; }
+	Move(const Move &) = default;
+	Move & operator=(const Move &) = default;
 	Move(Char_I x, Char_I y);
 	Move(Act_I act);
 
@@ -64,7 +65,7 @@ inline Move::Move(Char_I x, Char_I y) : m_x(x), m_y(y)
 #endif
 }
 
-inline Move::Move(Act_I act)
+inline Move::Move(Act_I act) : m_y(0)
 {
 	if (act == Act::PASS)
 		m_x = -1;
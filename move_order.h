@@ -0,0 +1,82 @@
+#pragma once
+#include "geometry.h"
+
+// how Tree::next_move() orders the placings that don't eat stones
+// RANDOM: random order
+// HISTORY: killer moves first, then by the history table, random order for the same score
+enum class Order : Char { RANDOM, HISTORY };
+typedef const Order Order_I;
+
+// move ordering tables for Tree::solve()
+// history table: how often a move refuted a node, indexed by the color to move and the point, both relative to the config
+// so that the same move in symmetric boards shares the same entry
+// killer moves: the last two refutations at each depth of the path, in the board of the node
+class MoveOrder
+{
+private:
+	Order m_order;
+	Int m_history[2][64];
+	vector<Move> m_killers; // 2 per depth, Act::END if none
+
+	// index of a config color
+	static Int color(Who_I who_config) { return who_config == Who::WHITE ? 1 : 0; }
+
+	// index of a point in the config
+	static Int config_point(Move_I move, Trans_I trans)
+	{
+		Char x = move.x(), y = move.y();
+		inv_transf(x, y, trans.rot());
+		return x + board_Nx() * y;
+	}
+
+public:
+	static const Int killer_score = 1 << 30;
+
+	MoveOrder() : m_order(Order::HISTORY) { clear(); }
+
+	Order order() const { return m_order; }
+
+	void set_order(Order_I order) { m_order = order; }
+
+	// forget all refutations
+	void clear()
+	{
+		for (Int i = 0; i < 64; ++i)
+			m_history[0][i] = m_history[1][i] = 0;
+		m_killers.clear();
+	}
+
+	// score of each point of a node board for MoveGen::generate(), larger is tried first
+	// 'who_config' is the color to move relative to the config, 'depth' = -1 if killer moves are not used
+	void scores(Int *score, Who_I who_config, Trans_I trans, Int_I depth) const
+	{
+		Int i, Nxy = board_Nx() * board_Ny();
+		const Int *history = m_history[color(who_config)];
+		for (i = 0; i < Nxy; ++i)
+			score[i] = history[config_point(Move(i % board_Nx(), i / board_Nx()), trans)];
+		if (depth >= 0 && 2 * depth + 1 < (Int)m_killers.size()) {
+			for (i = 0; i < 2; ++i) {
+				Move move = m_killers[2 * depth + i];
+				if (move.isplace())
+					score[move.x() + board_Nx() * move.y()] = killer_score - i;
+			}
+		}
+	}
+
+	// record a placing of a node (in the node board) that refuted the node
+	void refute(Move_I move, Who_I who_config, Trans_I trans, Int_I depth, Int_I bonus)
+	{
+		if (!move.isplace())
+			return;
+		Int &h = m_history[color(who_config)][config_point(move, trans)];
+		h = MIN(h + bonus, killer_score / 2);
+		if (depth < 0)
+			return;
+		if (2 * depth + 1 >= (Int)m_killers.size())
+			m_killers.resize(2 * depth + 2, Move(Act::END));
+		if (!(m_killers[2 * depth] == move)) {
+			m_killers[2 * depth + 1] = m_killers[2 * depth];
+			m_killers[2 * depth] = move;
+		}
+	}
+};
@@ -0,0 +1,99 @@
+#pragma once
+#include <algorithm>
+#include "grouptable.h"
+
+// candidate moves of a node, generated once in the order they should be tried:
+// placings that eat stones (more stones first), other legal non-dumb placings in random order (or by score), then pass
+// the caller keeps the generator and takes moves with next(), so expanding k children costs one generation
+// a move is not checked for an existing child or ko, Tree::next_move() does that
+class MoveGen
+{
+private:
+	static const Int Nmax = 65; // all points and pass
+	Move m_moves[Nmax];
+	Int m_size; // number of moves, -1 if not generated
+	Int m_cursor; // next move to take
+
+public:
+	MoveGen() : m_size(-1), m_cursor(0) {}
+
+	Bool generated() const { return m_size >= 0; }
+
+	Int size() const { return m_size; }
+
+	// generate all moves of a board, 'who' is the player to move
+	// if 'score' is given (indexed by x + Nx*y, see MoveOrder::scores()), placings that don't eat are sorted by score, larger first
+	void generate(Config_I config, Who_I who, const Int *score = nullptr);
+
+	// take the next move
+	// return false if all moves are taken
+	Bool next(Move_O move);
+
+	// generate again on next use
+	void reset() { m_size = -1; m_cursor = 0; }
+};
+
+inline void MoveGen::generate(Config_I config, Who_I who, const Int *score)
+{
+	Int i, j, n, Neat, Neat_pos, Nx = board_Nx(), Nxy = Nx * board_Ny();
+	Char x, y;
+	Bits listed = 0;
+	Char perm[Nmax];
+	GroupTable groups;
+	static thread_local vector<Move> eat_pos;
+
+	groups.build(config);
+	m_size = 0; m_cursor = 0;
+
+	// placings that can eat stones
+	groups.eat_list(eat_pos, who); Neat_pos = eat_pos.size();
+	for (i = 0; i < Neat_pos; ++i) {
+		x = eat_pos[i].x(); y = eat_pos[i].y();
+		if (groups.check(x, y, who) < 0)
+			continue;
+		m_moves[m_size++] = eat_pos[i];
+		listed |= bit(x, y);
+	}
+	Neat = m_size;
+
+	// random sequence of all grid points on board (Fisher-Yates)
+	for (i = 0; i < Nxy; ++i)
+		perm[i] = i;
+	for (n = Nxy; n > 1; --n) {
+		j = randInt(n);
+		std::swap(perm[n - 1], perm[j]);
+	}
+
+	for (i = 0; i < Nxy; ++i) {
+		x = perm[i] % Nx; y = perm[i] / Nx;
+		if (listed & bit(x, y))
+			continue;
+		// check legal and number of removal
+		if (groups.check(x, y, who) < 0)
+			continue;
+		// check dumb eye filling
+		if (groups.is_dumb_eye_filling(x, y, who))
+			continue;
+		if (config.is_dumb_2eye_filling(x, y, who))
+			continue;
+		m_moves[m_size++] = Move(x, y);
+	}
+
+	// stable, so the same score stays in random order
+	if (score) {
+		std::stable_sort(m_moves + Neat, m_moves + m_size, [score, Nx](Move_I a, Move_I b) {
+			return score[a.x() + Nx * a.y()] > score[b.x() + Nx * b.y()];
+		});
+	}
+
+	// passing is always the last move
+	m_moves[m_size++] = Move(Act::PASS);
+}
+
+inline Bool MoveGen::next(Move_O move)
+{
+	if (m_cursor >= m_size)
+		return false;
+	move = m_moves[m_cursor++];
+	return true;
+}
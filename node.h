@@ -1,31 +1,24 @@
 #include "move.h"
-#include "link.h"
+#include "bitboard.h"
+#include "linklist.h"
 
-// a node in the game tree
+class NodeStore;
+
+// a node in the game tree, a handle to the data in a NodeStore
 // a fork index (forkInd) is an index for m_last or m_next
 // Move is the move that caused the current board
+// a const Node only allows reading
 class Node
 {
 private:
-	// === data members ===
-
-	Who m_who; // who played this node
-	vector<Linkp> m_next; // tree indices to next nodes (-1: end node)
-	vector<Linkp> m_last; // for 0-th node: undefined
-	Long m_poolInd; // pool index, board stored in Pool::m_board[m_pool_ind]
-	Trans m_trans; // transformations needed for the config
-	// solution related
-	Sol m_sol; // Sol::GOOD/Sol::BAD/Sol::FAIR
-	Int m_score2; // an over-estimation of final score (two gods playing), -1 means unclear
-
-	// mark for keeping track of the path and searching
-	// default value: 0
-	// on path node: 1
-	// searched off path node: -1
-	Char m_mark;
+	NodeStore *m_store;
+	Long m_ind; // tree index
+
+	// clear the tried move of a child before it is removed
+	void delete_tried(Int_I forkInd);
 
 public:
-	Node() : m_sol(Sol::UNKNOWN), m_score2(-1), m_mark(0) {}
+	Node(NodeStore *store, Long_I ind) : m_store(store), m_ind(ind) {}
 
 	// properties
 
@@ -40,9 +33,9 @@ public:
 		return is_ko_sol(solution());
 	}
 
-	const Trans & trans() const;
+	Trans trans() const;
 
-	Int nlast() const { return m_last.size(); }
+	Int nlast() const;
 
 	// link for a parent
 	// forkInd = -1 : last element, forkInd = -2 : second last element, etc.
@@ -60,8 +53,8 @@ public:
 	// forkInd = -1 : last element, forkInd = -2 : second last element, etc.
 	Linkp next(Int_I forkInd = 0) const;
 
-	// set 0-th node (empty board)
-	void init();
+	// set 0-th node (empty board), "plink" is a new link for the init link
+	void init(Linkp_I plink);
 
 	Int score2() const;
 
@@ -80,62 +73,112 @@ public:
 	// change a next link
 	void set_next(Int_I forkInd, Linkp_I plink);
 
+	// if a child of the move exists, in O(1)
+	Bool tried(Move_I move) const;
+
+	// if rand_smart_move() found that all legal moves are tried
+	Bool all_tried() const;
+
+	void set_all_tried();
+
 	// change a last link
 	void set_last(Int_I forkInd, Linkp_I plink);
 
-	// remove one link from m_last
+	// remove one link from m_last, in O(1) (the last parent takes its fork index)
 	// will not deallocate link!
 	void delete_last(Int_I forkInd);
 
-	// remove one link from m_next
+	// remove one link from m_next, the order of other children is kept
 	// will not deallocate link!
 	void delete_next(Int_I forkInd);
+};
 
-	Char mark() const
+// all nodes of a Tree, stored as structure of arrays indexed by treeInd
+// scans of solutions and scores only touch the dense arrays
+class NodeStore
+{
+public:
+	// === hot data ===
+	vector<Sol> m_sol; // Sol::GOOD/Sol::BAD/Sol::FAIR
+	vector<Uchar> m_score2; // score2 + 1, score2 is an over-estimation of final score (two gods playing), -1 means unclear
+	vector<Who> m_who; // who played this node
+
+	// === cold data ===
+	vector<Int> m_poolInd; // pool index, board stored in Pool
+	vector<Char> m_trans; // trans2int() of the transformation needed for the config
+
+	// moves of the children, bit x + Nx*y for a placing
+	vector<Bits> m_tried;
+	// bit 0: pass is tried, bit 1: all legal moves are tried (cleared when a child is deleted)
+	vector<Uchar> m_tried_flag;
+
+	// === adjacency ===
+	// most nodes have one parent and a few children
+	vector<LinkList<4>> m_next; // links to next nodes
+	vector<LinkList<2>> m_last; // links to last nodes
+	LinkBlocks m_blocks; // overflow of m_next and m_last
+
+	Long size() const { return m_sol.size(); }
+
+	// add a node
+	void emplace_back()
 	{
-		return m_mark;
+		m_sol.push_back(Sol::UNKNOWN); m_score2.push_back(0);
+		m_who.push_back(Who::NONE); m_poolInd.push_back(-1); m_trans.push_back(0);
+		m_tried.push_back(0); m_tried_flag.push_back(0);
+		m_next.emplace_back(); m_last.emplace_back();
 	}
 
-	Char &mark()
-	{
-		return m_mark;
-	}
+	Node operator[](Long_I treeInd) { return Node(this, treeInd); }
+
+	const Node operator[](Long_I treeInd) const { return Node(const_cast<NodeStore *>(this), treeInd); }
+
+	Node back() { return Node(this, size() - 1); }
+
+	// write all nodes, links are converted to indices of 'links'
+	void save(CkptWriter &out, const LinkArena &links) const;
+
+	// read nodes written by save()
+	void load(CkptReader &in, const LinkArena &links);
 };
 
 inline Who Node::who() const
 {
-	return m_who;
+	return m_store->m_who[m_ind];
 }
 
 inline Bool Node::isinit() const
 {
-	if (m_last.size() == 1 & m_last[0]->isinit())
+	if (nlast() == 1 && last(0)->isinit())
 		return true;
 	return false;
 }
 
 inline Long Node::poolInd() const
 {
-	return m_poolInd;
+	return m_store->m_poolInd[m_ind];
+}
+
+inline Trans Node::trans() const
+{
+	Char t = m_store->m_trans[m_ind];
+	return Trans(t / 2, t % 2);
 }
 
-inline const Trans & Node::trans() const
+inline Int Node::nlast() const
 {
-	return m_trans;
+	return m_store->m_last[m_ind].size();
 }
 
 inline Linkp Node::last(Int_I ind) const
 {
-	Long treeInd;
-	if (ind < 0)
-		return m_last[nnext() + ind];
-	else
-		return m_last[ind];
+	const LinkList<2> &last = m_store->m_last[m_ind];
+	return last.get(ind < 0 ? last.size() + ind : ind, m_store->m_blocks);
 }
 
 inline Int Node::nnext() const
 {
-	return m_next.size();
+	return m_store->m_next[m_ind].size();
 }
 
 inline const Int Node::last_forkInd(Linkp_I plink) const
@@ -162,25 +205,21 @@ inline const Int Node::next_forkInd(Linkp_I plink) const
 
 inline Linkp Node::next(Int_I ind) const
 {
-	Long treeInd;
-	if (ind < 0)
-		return m_next[nnext() + ind];
-	else
-		return m_next[ind];
+	const LinkList<4> &next = m_store->m_next[m_ind];
+	return next.get(ind < 0 ? next.size() + ind : ind, m_store->m_blocks);
 }
 
-inline void Node::init()
+inline void Node::init(Linkp_I plink)
 {
-	m_last.resize(0);
-	Linkp plink = Linkp::newlink();
+	m_store->m_last[m_ind].clear(m_store->m_blocks);
 	plink->init();
-	m_last.push_back(plink);
-	m_who = Who::NONE; m_poolInd = 0;
+	push_last(plink);
+	m_store->m_who[m_ind] = Who::NONE; m_store->m_poolInd[m_ind] = 0;
 }
 
 inline Int Node::score2() const
 {
-	return m_score2;
+	return Int(m_store->m_score2[m_ind]) - 1;
 }
 
 inline void Node::set_sco2(Int_I score2)
@@ -189,60 +228,126 @@ inline void Node::set_sco2(Int_I score2)
 	if (score2 < 0 || score2 > board_Nx()*board_Ny() * 2)
 		error("illegal score2!");
 #endif
-	m_score2 = score2;
+	m_store->m_score2[m_ind] = score2 + 1;
 }
 
 inline Sol Node::solution() const
 {
-	return m_sol;
+	return m_store->m_sol[m_ind];
 }
 
 inline void Node::set_solution(Sol_I sol)
 {
-	m_sol = sol;
+	m_store->m_sol[m_ind] = sol;
 }
 
 inline void Node::push_last(Linkp_I plink)
 {
-	m_last.push_back(plink);
+	m_store->m_last[m_ind].push_back(plink, m_store->m_blocks);
 }
 
 inline void Node::push_next(Linkp_I plink)
 {
-	m_next.push_back(plink);
+	m_store->m_next[m_ind].push_back(plink, m_store->m_blocks);
+	Move move = plink->move();
+	if (move.isplace())
+		m_store->m_tried[m_ind] |= Bits(1) << (move.x() + board_Nx()*move.y());
+	else if (move.ispass())
+		m_store->m_tried_flag[m_ind] |= 1;
 }
 
 inline void Node::set(Who_I who, Long_I poolInd, Trans_I trans)
 {
-	m_who = who; m_poolInd = poolInd; m_trans = trans;
+	m_store->m_who[m_ind] = who; m_store->m_poolInd[m_ind] = poolInd;
+	m_store->m_trans[m_ind] = trans2int(trans);
 }
 
 inline void Node::set_last(Int_I forkInd, Linkp_I plink)
 {
-	m_last[forkInd] = plink;
+	m_store->m_last[m_ind].set(forkInd, plink, m_store->m_blocks);
 }
 
 inline void Node::set_next(Int_I forkInd, Linkp_I plink)
 {
-	m_next[forkInd] = plink;
+	delete_tried(forkInd);
+	m_store->m_next[m_ind].set(forkInd, plink, m_store->m_blocks);
+	Move move = plink->move();
+	if (move.isplace())
+		m_store->m_tried[m_ind] |= Bits(1) << (move.x() + board_Nx()*move.y());
+	else if (move.ispass())
+		m_store->m_tried_flag[m_ind] |= 1;
+}
+
+inline Bool Node::tried(Move_I move) const
+{
+	if (move.isplace())
+		return (m_store->m_tried[m_ind] >> (move.x() + board_Nx()*move.y())) & 1;
+	else if (move.ispass())
+		return m_store->m_tried_flag[m_ind] & 1;
+	return false;
+}
+
+inline Bool Node::all_tried() const
+{
+	return m_store->m_tried_flag[m_ind] & 2;
+}
+
+inline void Node::set_all_tried()
+{
+	m_store->m_tried_flag[m_ind] |= 2;
+}
+
+inline void Node::delete_tried(Int_I forkInd)
+{
+	Move move = next(forkInd)->move();
+	if (move.isplace())
+		m_store->m_tried[m_ind] &= ~(Bits(1) << (move.x() + board_Nx()*move.y()));
+	else if (move.ispass())
+		m_store->m_tried_flag[m_ind] &= ~Uchar(1);
+	m_store->m_tried_flag[m_ind] &= ~Uchar(2);
 }
 
 inline void Node::delete_last(Int_I forkInd)
 {
-	if (forkInd < 0) {
-		m_last.erase(m_last.end() + forkInd);
-	}
-	else {
-		m_last.erase(m_last.begin() + forkInd);
-	}
+	LinkList<2> &last = m_store->m_last[m_ind];
+	last.swap_erase(forkInd < 0 ? last.size() + forkInd : forkInd, m_store->m_blocks);
 }
 
 inline void Node::delete_next(Int_I forkInd)
 {
-	if (forkInd < 0) {
-		m_next.erase(m_next.end() + forkInd);
-	}
-	else {
-		m_next.erase(m_next.begin() + forkInd);
+	LinkList<4> &next = m_store->m_next[m_ind];
+	delete_tried(forkInd);
+	next.erase(forkInd < 0 ? next.size() + forkInd : forkInd, m_store->m_blocks);
+}
+
+inline void NodeStore::save(CkptWriter &out, const LinkArena &links) const
+{
+	auto encode = [&links](Linkp_I plink) { return links.encode(plink); };
+	out.write(m_sol); out.write(m_score2); out.write(m_who);
+	out.write(m_poolInd); out.write(m_trans);
+	out.write(m_tried); out.write(m_tried_flag);
+	out.write(m_next.data(), size(), [&encode](const LinkList<4> &list) { return list.map(encode); });
+	out.write(m_last.data(), size(), [&encode](const LinkList<2> &list) { return list.map(encode); });
+	out.write(m_blocks.m_data.data(), m_blocks.m_data.size(), encode);
+	for (Int i = 0; i < LinkBlocks::Ncls; ++i)
+		out.write(m_blocks.m_free[i]);
+}
+
+inline void NodeStore::load(CkptReader &in, const LinkArena &links)
+{
+	Long i;
+	auto decode = [&links](Linkp_I plink) { return links.decode(plink); };
+	in.read(m_sol); in.read(m_score2); in.read(m_who);
+	in.read(m_poolInd); in.read(m_trans);
+	in.read(m_tried); in.read(m_tried_flag);
+	in.read(m_next); in.read(m_last); in.read(m_blocks.m_data);
+	for (i = 0; i < LinkBlocks::Ncls; ++i)
+		in.read(m_blocks.m_free[i]);
+	// fix up the links
+	for (i = 0; i < size(); ++i) {
+		m_next[i] = m_next[i].map(decode);
+		m_last[i] = m_last[i].map(decode);
 	}
+	for (i = 0; i < (Long)m_blocks.m_data.size(); ++i)
+		m_blocks.m_data[i] = decode(m_blocks.m_data[i]);
 }
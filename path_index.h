@@ -0,0 +1,76 @@
+#pragma once
+#include "common.h"
+
+// the nodes on the current path of Tree::solve(), from the root
+// each situation has only one tree index, so the path is indexed by treeInd
+// also keeps a visited set for graph searches of the tree, cleared in O(1) by a new stamp
+class PathIndex
+{
+private:
+	vector<Long> m_path; // tree index of path nodes
+	vector<Int> m_depth; // depth + 1 of a path node, 0 if not on path
+	vector<Uint> m_visit; // stamp of the last search that visited a node
+	Uint m_stamp; // stamp of the current search
+
+public:
+	PathIndex() : m_stamp(0) {}
+
+	Long size() const { return m_path.size(); }
+
+	Bool empty() const { return m_path.empty(); }
+
+	// tree index of the path node at a depth
+	Long operator[](Long_I depth) const { return m_path[depth]; }
+
+	Long back() const { return m_path.back(); }
+
+	Bool on_path(Long_I treeInd) const
+	{
+		return treeInd < (Long)m_depth.size() && m_depth[treeInd] > 0;
+	}
+
+	// depth of a path node (root is 0), -1 if not on path
+	Long depth(Long_I treeInd) const
+	{
+		return treeInd < (Long)m_depth.size() ? m_depth[treeInd] - 1 : -1;
+	}
+
+	// add a node to the end of the path
+	void push(Long_I treeInd)
+	{
+		if (treeInd >= (Long)m_depth.size())
+			m_depth.resize(treeInd + 1, 0);
+		if (m_depth[treeInd] > 0)
+			error("node already on path!");
+		m_path.push_back(treeInd);
+		m_depth[treeInd] = m_path.size();
+	}
+
+	// remove the last node from the path
+	void pop()
+	{
+		m_depth[m_path.back()] = 0;
+		m_path.pop_back();
+	}
+
+	// start a new search, no node is visited
+	void new_search()
+	{
+		if (++m_stamp == 0) {
+			m_visit.assign(m_visit.size(), 0);
+			m_stamp = 1;
+		}
+	}
+
+	// mark a node visited in the current search
+	// return false if it is already visited
+	Bool visit(Long_I treeInd)
+	{
+		if (treeInd >= (Long)m_visit.size())
+			m_visit.resize(treeInd + 1, 0);
+		if (m_visit[treeInd] == m_stamp)
+			return false;
+		m_visit[treeInd] = m_stamp;
+		return true;
+	}
+};
@@ -0,0 +1,131 @@
+#pragma once
+#include "board.h"
+#include "grouptable.h"
+
+// throughput tests of the rule kernels, without the tree
+// leaf counts depend only on the rules, so they also check optimizations of the rule kernels
+
+// result of perft() or sgf_replay()
+class PerftCount
+{
+public:
+	Long leaves; // perft(): move sequences of full depth or ended by double pass; sgf_replay(): lines
+	Long positions; // positions visited (perft) or moves played (sgf_replay)
+	Long illegal; // illegal moves in the SGF file
+
+	PerftCount() : leaves(0), positions(0), illegal(0) {}
+};
+
+// count all move sequences of a depth from a config, 'who' is the player to move
+// moves are legal non-dumb placings (same filters as MoveGen, ko not considered) and pass, double pass ends the game
+// 'passed' is true if the last move is pass
+inline void perft(PerftCount &count, Config_I config, Who_I who, Int_I depth, Bool_I passed = false)
+{
+	Int i, Nx = board_Nx(), Nxy = Nx * board_Ny();
+	Char x, y;
+	++count.positions;
+	if (depth == 0) {
+		++count.leaves;
+		return;
+	}
+	for (i = 0; i < Nxy; ++i) {
+		x = i % Nx; y = i / Nx;
+		if (config.check(x, y, who) < 0)
+			continue;
+		if (config.is_dumb_eye_filling(x, y, who) || config.is_dumb_2eye_filling(x, y, who))
+			continue;
+		Config config1 = config;
+		config1.place(x, y, who);
+		perft(count, config1, ::next(who), depth - 1);
+	}
+	// pass
+	if (passed) {
+		++count.positions; ++count.leaves; // game ended
+	}
+	else
+		perft(count, config, ::next(who), depth - 1, true);
+}
+
+// same as perft(), but the groups are updated by GroupTable::place() along the search instead of the rule kernels
+// the leaf counts must be the same as perft()
+inline void perft_groups(PerftCount &count, const GroupTable &groups, Who_I who, Int_I depth, Bool_I passed = false)
+{
+	Int i, Nx = board_Nx(), Nxy = Nx * board_Ny();
+	Char x, y;
+	++count.positions;
+	if (depth == 0) {
+		++count.leaves;
+		return;
+	}
+	for (i = 0; i < Nxy; ++i) {
+		x = i % Nx; y = i / Nx;
+		if (groups.check(x, y, who) < 0)
+			continue;
+		if (groups.is_dumb_eye_filling(x, y, who)
+			|| rules().is_dumb_2eye_filling(groups.stones(who), groups.stones(::next(who)), i))
+			continue;
+		GroupTable groups1 = groups;
+		groups1.place(x, y, who);
+		perft_groups(count, groups1, ::next(who), depth - 1);
+	}
+	// pass
+	if (passed) {
+		++count.positions; ++count.leaves; // game ended
+	}
+	else
+		perft_groups(count, groups, ::next(who), depth - 1, true);
+}
+
+// read the board size of an SGF file (property SZ[n] or SZ[nx:ny])
+// return false if not found
+inline Bool sgf_size(Int_O Nx, Int_O Ny, const string &sgf)
+{
+	size_t ind = sgf.find("SZ[");
+	if (ind == string::npos)
+		return false;
+	Nx = Ny = atoi(sgf.c_str() + ind + 3);
+	size_t colon = sgf.find_first_of(":]", ind);
+	if (colon != string::npos && sgf[colon] == ':')
+		Ny = atoi(sgf.c_str() + colon + 1);
+	return true;
+}
+
+// replay every line of an SGF file with Board::place(), shared moves of lines are played once
+// properties other than B[] and W[] are skipped, B[] or W[] with no coordinates is pass
+inline void sgf_replay(PerftCount &count, const string &sgf)
+{
+	Long i, N = sgf.size();
+	Bool has_move = false; // a move is played since the last '('
+	vector<Board> stack; // board at each '('
+	Board board; board.init();
+
+	for (i = 0; i < N; ++i) {
+		Char c = sgf[i];
+		if (c == '(') {
+			stack.push_back(board);
+			has_move = false;
+		}
+		else if (c == ')') {
+			if (stack.empty())
+				error("illegal SGF file!");
+			if (has_move)
+				++count.leaves; // end of a line
+			board = stack.back(); stack.pop_back();
+			has_move = false;
+		}
+		else if (c == '[') {
+			// property value, skip escaped ']'
+			Long j = i + 1;
+			while (j < N && sgf[j] != ']')
+				j += sgf[j] == '\\' ? 2 : 1;
+			// property name is right before '['
+			if ((sgf[i - 1] == 'B' || sgf[i - 1] == 'W') && (i < 2 || !isupper(sgf[i - 2]))) {
+				Who who = sgf[i - 1] == 'B' ? Who::BLACK : Who::WHITE;
+				++count.positions; has_move = true;
+				if (j - i == 3 && board.place(sgf[i + 1] - 'a', sgf[i + 2] - 'a', who) < 0)
+					++count.illegal;
+			}
+			i = j;
+		}
+	}
+}
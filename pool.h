@@ -1,161 +1,305 @@
 #pragma once
+#include <atomic>
+#include <mutex>
 #include "board.h"
 
-// all situations in the tree, sorted for quick search
-// sorting: each board is a radix 3 number, sort these numbers with ascending order
-// a pool index (poolInd) is an index for m_boards, this index should never change for the same board
+// one configuration in the Pool
+// the corresponding node played by black/white
+// black/white here is relative to the config, not the situation (they are different if there is a color flip)
+// use -1 if there is no link
+class PoolEntry
+{
+public:
+	ConfigCode m_board;
+	std::atomic<Long> m_black_treeInd;
+	std::atomic<Long> m_white_treeInd;
+
+	PoolEntry() : m_black_treeInd(-1), m_white_treeInd(-1) {}
+};
+
+// one shard of the Pool hash table, guarded by its own mutex
+// m_table is an open addressing hash table (linear probing) of pool indices, -1 for empty slot, size is a power of 2
+class PoolShard
+{
+public:
+	mutable std::mutex m_mutex;
+	vector<Long> m_table;
+	Long m_size; // number of configs in this shard
+
+	PoolShard() : m_table(64, -1), m_size(0) {}
+};
+
+// all situations in the tree, indexed by zobrist hash for quick search
+// a pool index (poolInd) is an index of an entry, this index should never change for the same board
 // m_treeInd will link to a tree node that is not a Act::PASS
-// index to m_order is called (pool) order index (orderInd), this will change frequently for the same board!
+// boards are stored packed as ConfigCode, and unpacked to Config only when needed
+// thread safe: the hash table is sharded by the high bits of Config::hash(), each shard has a lock
+// entries are stored in chunks that never move, so a pool index can be read without lock once it is found
+// chunks are found by a two level directory, pages of the directory are allocated when needed
 class Pool
 {
 private:
-	vector<Config> m_boards; // store all boards in the Pool
-	// the corresponding node played by black/white
-	// black/white here is relative to the config, not the situation (they are different if there is a color flip)
-	// m_black_treeInd and m_white_treeInd should always be the same length and order of m_boards, use -1 if there is no link
-	vector<Long> m_black_treeInd;
-	vector<Long> m_white_treeInd;
-	vector<Long> m_order; // m_board[m_order[i]] is in sorted order
+	static const Int Nshard_bit = 4;
+	static const Int Nshard = 1 << Nshard_bit;
+	static const Int Nchunk_bit = 12; // entries per chunk
+	static const Int Npage_bit = 8; // chunks per directory page
+	static const Long Npage_max = 1 << 8;
+
+	typedef std::atomic<PoolEntry *> ChunkPtr;
+
+	PoolShard m_shards[Nshard];
+	std::atomic<ChunkPtr *> m_pages[Npage_max];
+	std::mutex m_chunk_mutex; // for allocating chunks and pages
+	std::atomic<Long> m_size;
+
+	PoolShard & shard(Ullong_I hash) { return m_shards[hash >> (64 - Nshard_bit)]; }
+	const PoolShard & shard(Ullong_I hash) const { return m_shards[hash >> (64 - Nshard_bit)]; }
+
+	// get an entry, the chunk must exist
+	PoolEntry & entry(Long_I poolInd) const
+	{
+		Long chunkInd = poolInd >> Nchunk_bit;
+		ChunkPtr *page = m_pages[chunkInd >> Npage_bit].load(std::memory_order_acquire);
+		return page[chunkInd & ((1 << Npage_bit) - 1)].load(std::memory_order_acquire)[poolInd & ((1 << Nchunk_bit) - 1)];
+	}
+
+	// find a config in a locked shard, return -1 if not found
+	Long find(const PoolShard &sh, Config_I config) const;
+
+	// allocate a new entry and return the pool index
+	Long new_entry();
+
+	// free all chunks and pages (no other thread may use the Pool)
+	void free_chunks();
+
+	// rebuild m_table of a locked shard with a new size (power of 2)
+	void rehash(PoolShard &sh, Long_I Nslot);
 
 public:
-	Pool() {}
+	Pool();
 
-	Long size() const { return m_boards.size(); }
+	Pool(const Pool &) = delete;
+	Pool & operator=(const Pool &) = delete;
 
-	// get a board reference by order index
-	const Config & operator[](Long_I orderInd) const;
+	Long size() const { return m_size.load(std::memory_order_acquire); }
 
-	// get a board reference by pool index
-	const Config & operator()(Long_I poolInd) const;
+	// get a board by pool index
+	Config operator()(Long_I poolInd) const;
 
-	// get pool index from order index
-	Long poolInd(Long_I orderInd) const;
+	// search Pool: find poolInd so that the board of poolInd and config have the same configuration
+	// config must already be canonicalized by Config::calc_trans() or Config::canonicalize()
+	// return 0, output poolInd: if board is found
+	// return -1: if board is not found
+	Int search(Long_O poolInd, Config_I config) const;
 
-	// search Pool: find poolInd so that m_board[poolInd] and raw_board have the same configuration
-	// return 0, output ind: if board is found
-	// return -1: if board is not found and board is too small
-	// return  1: if board is not found and board is too large
-	// return -2: if board is not found and board is in the middle, output ind so that m_pool[ind] < s < m_pool[ind+1]
-	// return -3: if m_pool.size() < 1
-	// TODO: improve implementation (stone by stone algorithm)
-	// output flip and rotation calculated by Config::calc_trans()
-	Int search(Long_O poolInd, Long_O orderInd, Config_I board) const;
+	// find a config, or add it if not found (atomic)
+	// config must already be canonicalized
+	// return 0 if found, return 1 if added, output poolInd for both
+	Int insert(Long_O poolInd, Config_I config);
 
 	// return the treeInd of a situation
 	// 'who_config' is relative to configuration not situation
 	// return -1 if situation does not exist
 	Long treeInd(Long_I poolInd, Who_I who_config) const;
 
-	// push one element to m_black_treeInd and m_white_treeInd
-	// 'who' is relative to the situation
-	void push_treeInd(Long_I treeInd, Who_I who, Bool_I flip);
+	// link a situation of an existing configuration to a tree node, unless another node is linked first (atomic)
+	// 'who' is relative to the config, not situation
+	// return the treeInd linked to the situation (equals treeInd if linked by this call)
+	Long link(Long_I poolInd, Who_I who_config, Long_I treeInd);
 
-	// move a config to the Pool (config will be destroyed)
-	// 'who' is relative to the situation
-	// orderInd is output by search() and search_ret is returned by search()
-	void push(Config_IO config, Bool_I flip, Int_I search_ret, Long_I orderInd, Who_I who, Long_I treeInd);
+	// write all entries and hash tables (no other thread may use the Pool)
+	void save(CkptWriter &out) const;
 
-	// add a new situation to an existing configuration
-	// 'who' is relative to the config, not situation
-	// this function is so awkward....
-	void link(Long_I orderInd, Who_I who_config, Long_I treeInd);
+	// replace the Pool by one written by save()
+	void load(CkptReader &in);
+
+	~Pool();
 };
 
-inline const Config & Pool::operator[](Long_I orderInd) const
+inline Pool::Pool() : m_size(0)
 {
-	return m_boards[m_order[orderInd]];
+	for (Long i = 0; i < Npage_max; ++i)
+		m_pages[i].store(nullptr, std::memory_order_relaxed);
 }
 
-inline const Config & Pool::operator()(Long_I poolInd) const
+inline Config Pool::operator()(Long_I poolInd) const
 {
-	return m_boards[poolInd];
+	Config config;
+	config.init(entry(poolInd).m_board);
+	return config;
 }
 
-inline Long Pool::poolInd(Long_I orderInd) const
+inline Long Pool::find(const PoolShard &sh, Config_I config) const
 {
-	return m_order[orderInd];
+	Long mask = sh.m_table.size() - 1, slot = config.hash() & mask, ind;
+	ConfigCode code = config.code();
+	for (;; slot = (slot + 1) & mask) {
+		ind = sh.m_table[slot];
+		if (ind < 0 || entry(ind).m_board == code)
+			return ind;
+	}
 }
 
-Int Pool::search(Long_O poolInd, Long_O orderInd, Config_I config) const
+inline Int Pool::search(Long_O poolInd, Config_I config) const
 {
-	Int ret = lookupInt(orderInd, *this, config);
-	if (ret == 0)
-		poolInd = m_order[orderInd];
-	return ret;
+	GOS_PROF_SCOPE(Prof::POOL_SEARCH);
+	const PoolShard &sh = shard(config.hash());
+	std::lock_guard<std::mutex> lock(sh.m_mutex);
+	Long ind = find(sh, config);
+	if (ind < 0)
+		return -1;
+	poolInd = ind;
+	return 0;
 }
 
-inline void Pool::push_treeInd(Long_I treeInd, Who_I who, Bool_I flip)
+inline Long Pool::new_entry()
 {
-	Who who_config;
-	if (who == Who::NONE) { // for 0-th node
-		if (treeInd != 0)
-			error("only 0-th node can have Who::NONE!");
-		m_black_treeInd.push_back(0);
-		m_white_treeInd.push_back(0);
-	}
-	else {
-		if (who != Who::BLACK && who != Who::WHITE)
-			error("illegal who!");
-		if (flip)
-			who_config = next(who);
-		else
-			who_config = who;
-
-		if (who_config == Who::BLACK) {
-			m_black_treeInd.push_back(treeInd);
-			m_white_treeInd.push_back(-1);
-		}
-		else if (who_config == Who::WHITE) {
-			m_black_treeInd.push_back(-1);
-			m_white_treeInd.push_back(treeInd);
+	Long poolInd = m_size.fetch_add(1), chunkInd = poolInd >> Nchunk_bit;
+	Long pageInd = chunkInd >> Npage_bit, ind = chunkInd & ((1 << Npage_bit) - 1);
+	if (pageInd >= Npage_max)
+		error("Pool is full!");
+	ChunkPtr *page = m_pages[pageInd].load(std::memory_order_acquire);
+	if (!page || !page[ind].load(std::memory_order_acquire)) {
+		std::lock_guard<std::mutex> lock(m_chunk_mutex);
+		page = m_pages[pageInd].load(std::memory_order_relaxed);
+		if (!page) {
+			page = new ChunkPtr[1 << Npage_bit];
+			for (Long i = 0; i < (1 << Npage_bit); ++i)
+				page[i].store(nullptr, std::memory_order_relaxed);
+			m_pages[pageInd].store(page, std::memory_order_release);
 		}
+		if (!page[ind].load(std::memory_order_relaxed))
+			page[ind].store(new PoolEntry[1 << Nchunk_bit], std::memory_order_release);
 	}
+	return poolInd;
 }
 
-inline void Pool::push(Config_IO config, Bool_I flip, Int_I search_ret, Long_I orderInd, Who_I who, Long_I treeInd)
+inline void Pool::free_chunks()
 {
-	// transform the board first!
-	m_boards.emplace_back();  m_boards.back() << config;
-
-	push_treeInd(treeInd, who, flip);
+	for (Long i = 0; i < Npage_max; ++i) {
+		ChunkPtr *page = m_pages[i].load(std::memory_order_relaxed);
+		if (!page)
+			continue;
+		for (Long j = 0; j < (1 << Npage_bit); ++j)
+			delete[] page[j].load(std::memory_order_relaxed);
+		delete[] page;
+		m_pages[i].store(nullptr, std::memory_order_relaxed);
+	}
+}
 
-	Long poolInd = m_boards.size() - 1;
-	if (search_ret == -2)
-		m_order.insert(m_order.begin() + orderInd + 1, poolInd);
-	else if (search_ret == -1)
-		m_order.insert(m_order.begin(), poolInd);
-	else if (search_ret == 1 || search_ret == -3)
-		m_order.push_back(poolInd);
-	else
-		error("Pool::push(): unknown search_ret!");
+inline void Pool::rehash(PoolShard &sh, Long_I Nslot)
+{
+	Long i, slot, mask = Nslot - 1;
+	vector<Long> inds;
+	Config config;
+	for (i = 0; i < (Long)sh.m_table.size(); ++i)
+		if (sh.m_table[i] >= 0)
+			inds.push_back(sh.m_table[i]);
+	sh.m_table.assign(Nslot, -1);
+	for (i = 0; i < (Long)inds.size(); ++i) {
+		config.init(entry(inds[i]).m_board); // hash is not stored
+		slot = config.hash() & mask;
+		while (sh.m_table[slot] >= 0)
+			slot = (slot + 1) & mask;
+		sh.m_table[slot] = inds[i];
+	}
 }
 
-inline void Pool::link(Long_I orderInd, Who_I who_config, Long_I treeInd)
+inline Int Pool::insert(Long_O poolInd, Config_I config)
 {
-	Long poolInd = this->poolInd(orderInd);
+	GOS_PROF_SCOPE(Prof::POOL_INSERT);
+	PoolShard &sh = shard(config.hash());
+	std::lock_guard<std::mutex> lock(sh.m_mutex);
+	Long ind = find(sh, config);
+	if (ind >= 0) {
+		poolInd = ind;
+		return 0;
+	}
 
+	// keep load factor below 1/2
+	if (2 * (sh.m_size + 1) > (Long)sh.m_table.size())
+		rehash(sh, 2 * sh.m_table.size());
+
+	// the entry is written before it can be found
+	poolInd = new_entry();
+	entry(poolInd).m_board = config.code();
+
+	Long mask = sh.m_table.size() - 1, slot = config.hash() & mask;
+	while (sh.m_table[slot] >= 0)
+		slot = (slot + 1) & mask;
+	sh.m_table[slot] = poolInd;
+	++sh.m_size;
+	return 1;
+}
+
+inline Long Pool::link(Long_I poolInd, Who_I who_config, Long_I treeInd)
+{
+	Long old = -1;
+	PoolEntry &ent = entry(poolInd);
 	if (who_config == Who::BLACK) {
-		if (m_black_treeInd[poolInd] > -1)
-			error("situation already exists!");
-		m_black_treeInd[poolInd] = treeInd;
+		if (!ent.m_black_treeInd.compare_exchange_strong(old, treeInd))
+			return old;
 	}
 	else if (who_config == Who::WHITE) {
-		if (m_white_treeInd[poolInd] > -1)
-			error("situation already exists!");
-		m_white_treeInd[poolInd] = treeInd;
+		if (!ent.m_white_treeInd.compare_exchange_strong(old, treeInd))
+			return old;
 	}
 	else
 		error("illegal who_config!");
+	return treeInd;
 }
 
-Long Pool::treeInd(Long_I poolInd, Who_I who_config) const
+inline Long Pool::treeInd(Long_I poolInd, Who_I who_config) const
 {
 	if (who_config == Who::BLACK) {
-		return m_black_treeInd[poolInd];
+		return entry(poolInd).m_black_treeInd.load();
 	}
 	else if (who_config == Who::WHITE) {
-		return m_white_treeInd[poolInd];
+		return entry(poolInd).m_white_treeInd.load();
 	}
 	else
 		error("illegal who!");
+	return -1;
+}
+
+inline void Pool::save(CkptWriter &out) const
+{
+	Long i, n = size();
+	vector<ConfigCode> boards(n);
+	vector<Long> black(n), white(n);
+	for (i = 0; i < n; ++i) {
+		boards[i] = entry(i).m_board;
+		black[i] = entry(i).m_black_treeInd.load(std::memory_order_relaxed);
+		white[i] = entry(i).m_white_treeInd.load(std::memory_order_relaxed);
+	}
+	out.write(boards); out.write(black); out.write(white);
+	for (i = 0; i < Nshard; ++i) {
+		out.write(m_shards[i].m_size);
+		out.write(m_shards[i].m_table);
+	}
+}
+
+inline void Pool::load(CkptReader &in)
+{
+	Long i, n;
+	free_chunks();
+	m_size.store(0);
+	const ConfigCode *boards = in.read_array<ConfigCode>(n);
+	const Long *black = in.read_array<Long>(n);
+	const Long *white = in.read_array<Long>(n);
+	for (i = 0; i < n; ++i) {
+		PoolEntry &e = entry(new_entry());
+		e.m_board = boards[i];
+		e.m_black_treeInd.store(black[i], std::memory_order_relaxed);
+		e.m_white_treeInd.store(white[i], std::memory_order_relaxed);
+	}
+	for (i = 0; i < Nshard; ++i) {
+		in.read(m_shards[i].m_size);
+		in.read(m_shards[i].m_table);
+	}
+}
+
+inline Pool::~Pool()
+{
+	free_chunks();
 }
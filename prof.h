@@ -0,0 +1,214 @@
+#pragma once
+#include "common.h"
+#include <atomic>
+#include <mutex>
+#include <cstdio>
+
+// hot path counters and scoped timers, only compiled with GOS_PROFILE defined
+// usage: GOS_PROF_SCOPE(Prof::CALC_TRANS); at the beginning of a function counts the calls and the time until return
+//        GOS_PROF_COUNT(Prof::CONFIG_PLACE); only counts the calls (for functions too short to time)
+// each thread has its own counters, prof_table() and prof_json() sum all threads
+// with GOS_PROFILE, the table is printed to stderr and the JSON is written to "prof.json" at exit
+// time is measured by slisc::ticks() (rdtsc), and includes the time of nested scopes
+
+// instrumented functions
+// stone connection is done inside Config::check() and Config::place() by the rule kernels (rules.h)
+enum class Prof : Int { CONFIG_CHECK, CONFIG_PLACE, CALC_TRANS, POOL_SEARCH, POOL_INSERT,
+	ISLINKED, ISLINKED0, WRITE_SGF, END };
+typedef const Prof &Prof_I;
+
+inline const char *prof_name(Prof_I id)
+{
+	static const char *names[] = { "Config::check", "Config::place", "Config::calc_trans", "Pool::search",
+		"Pool::insert", "Tree::islinked", "Tree::islinked0", "Tree::writeSGF" };
+	return names[Int(id)];
+}
+
+static const Int Nprof = Int(Prof::END);
+
+// counters of one thread
+// only the owner writes, so the relaxed load and store need no lock, other threads only read
+// no constructor, so a thread_local instance is zero initialized and needs no guard on access
+class ProfCounters
+{
+public:
+	std::atomic<Ullong> m_calls[Nprof];
+	std::atomic<Ullong> m_ticks[Nprof];
+	Bool m_registered;
+
+	void add(Int_I i, Ullong_I calls, Ullong_I ticks)
+	{
+		m_calls[i].store(m_calls[i].load(std::memory_order_relaxed) + calls, std::memory_order_relaxed);
+		m_ticks[i].store(m_ticks[i].load(std::memory_order_relaxed) + ticks, std::memory_order_relaxed);
+	}
+
+	void clear()
+	{
+		for (Int i = 0; i < Nprof; ++i) {
+			m_calls[i].store(0, std::memory_order_relaxed);
+			m_ticks[i].store(0, std::memory_order_relaxed);
+		}
+	}
+};
+
+// counters of all threads
+// a thread registers its counters on first use, and merges them into m_retired when it exits
+class ProfRegistry
+{
+public:
+	std::mutex m_mutex;
+	vector<ProfCounters *> m_live;
+	ProfCounters m_retired;
+
+	ProfRegistry() { m_retired.clear(); }
+
+	// sum of all threads
+	void sum(vector<Ullong> &calls, vector<Ullong> &ticks)
+	{
+		Int i, j;
+		std::lock_guard<std::mutex> lock(m_mutex);
+		calls.assign(Nprof, 0); ticks.assign(Nprof, 0);
+		for (i = 0; i < Nprof; ++i) {
+			calls[i] = m_retired.m_calls[i].load(std::memory_order_relaxed);
+			ticks[i] = m_retired.m_ticks[i].load(std::memory_order_relaxed);
+			for (j = 0; j < (Int)m_live.size(); ++j) {
+				calls[i] += m_live[j]->m_calls[i].load(std::memory_order_relaxed);
+				ticks[i] += m_live[j]->m_ticks[i].load(std::memory_order_relaxed);
+			}
+		}
+	}
+};
+
+// never destroyed, so threads exiting after main() can still retire
+inline ProfRegistry &prof_registry()
+{
+	static ProfRegistry *reg = new ProfRegistry;
+	return *reg;
+}
+
+// prints the table to stderr and writes "prof.json" when destroyed
+class ProfExitDump
+{
+public:
+	~ProfExitDump();
+};
+
+// registers the counters of a thread on construction, and retires them on destruction (thread exit)
+class ProfThread
+{
+public:
+	ProfCounters &m_counters;
+
+	ProfThread(ProfCounters &counters) : m_counters(counters)
+	{
+#ifdef GOS_PROFILE
+		// constructed before the first thread_local counters, so destroyed after them (and after the worker threads)
+		static ProfExitDump dump;
+#endif
+		ProfRegistry &reg = prof_registry();
+		std::lock_guard<std::mutex> lock(reg.m_mutex);
+		reg.m_live.push_back(&m_counters);
+		m_counters.m_registered = true;
+	}
+
+	~ProfThread()
+	{
+		ProfRegistry &reg = prof_registry();
+		std::lock_guard<std::mutex> lock(reg.m_mutex);
+		for (Int i = 0; i < Nprof; ++i)
+			reg.m_retired.add(i, m_counters.m_calls[i].load(std::memory_order_relaxed),
+				m_counters.m_ticks[i].load(std::memory_order_relaxed));
+		m_counters.clear();
+		for (Int j = 0; j < (Int)reg.m_live.size(); ++j) {
+			if (reg.m_live[j] == &m_counters) {
+				reg.m_live[j] = reg.m_live.back(); reg.m_live.pop_back();
+				break;
+			}
+		}
+	}
+};
+
+// counters of the calling thread
+inline ProfCounters &prof_counters()
+{
+	static thread_local ProfCounters counters;
+	if (!counters.m_registered)
+		static thread_local ProfThread thread(counters);
+	return counters;
+}
+
+// time a scope
+class ProfScope
+{
+private:
+	Int m_id;
+	Ullong m_start;
+public:
+	ProfScope(Prof_I id) : m_id(Int(id)), m_start(ticks()) {}
+	~ProfScope() { prof_counters().add(m_id, 1, ticks() - m_start); }
+};
+
+// clear all counters
+inline void prof_clear()
+{
+	// other threads may be writing, only clear the caller
+	prof_counters().clear();
+	ProfRegistry &reg = prof_registry();
+	std::lock_guard<std::mutex> lock(reg.m_mutex);
+	reg.m_retired.clear();
+}
+
+// human readable table of all counters, functions never called are skipped
+inline string prof_table()
+{
+	vector<Ullong> calls, ticks;
+	prof_registry().sum(calls, ticks);
+	Doub sec = tick_sec();
+	char line[256];
+	string str = "function                  calls        time(s)      ns/call\n";
+	for (Int i = 0; i < Nprof; ++i) {
+		if (calls[i] == 0)
+			continue;
+		if (ticks[i] == 0) // only counted
+			snprintf(line, sizeof(line), "%-22s %12llu\n", prof_name(Prof(i)), (unsigned long long)calls[i]);
+		else
+			snprintf(line, sizeof(line), "%-22s %12llu %14.6f %12.1f\n", prof_name(Prof(i)),
+				(unsigned long long)calls[i], ticks[i] * sec, ticks[i] * sec * 1e9 / calls[i]);
+		str += line;
+	}
+	return str;
+}
+
+// JSON object of all counters, {"name": {"calls": n, "time": t}, ...}
+inline string prof_json()
+{
+	vector<Ullong> calls, ticks;
+	prof_registry().sum(calls, ticks);
+	Doub sec = tick_sec();
+	char item[256];
+	string str = "{";
+	for (Int i = 0; i < Nprof; ++i) {
+		snprintf(item, sizeof(item), "%s\"%s\": {\"calls\": %llu, \"time\": %.6f}", i == 0 ? "" : ", ",
+			prof_name(Prof(i)), (unsigned long long)calls[i], ticks[i] * sec);
+		str += item;
+	}
+	return str + "}";
+}
+
+// dump at exit
+inline ProfExitDump::~ProfExitDump()
+{
+	fprintf(stderr, "\n=== profile ===\n%s", prof_table().c_str());
+	ofstream fout("prof.json");
+	fout << prof_json() << endl;
+}
+
+#ifdef GOS_PROFILE
+#define GOS_PROF_CAT0(a, b) a##b
+#define GOS_PROF_CAT(a, b) GOS_PROF_CAT0(a, b)
+#define GOS_PROF_SCOPE(id) ProfScope GOS_PROF_CAT(prof_scope_, __LINE__)(id)
+#define GOS_PROF_COUNT(id) prof_counters().add(Int(id), 1, 0)
+#else
+#define GOS_PROF_SCOPE(id)
+#define GOS_PROF_COUNT(id)
+#endif
@@ -0,0 +1,58 @@
+#pragma once
+#include "common.h"
+#include <cstdio>
+
+// how much Tree::solve() writes
+// QUIET: nothing
+// PROGRESS: one progress line at a fixed interval
+// NODE: also display every new node (slow, for debugging)
+enum class Log : Char { QUIET, PROGRESS, NODE };
+typedef const Log &Log_I;
+
+// rate limited progress report of a long solve, one JSON object per line
+class Progress
+{
+private:
+	FILE *m_out; // stderr or a file, nullptr for no output
+	Doub m_interval; // seconds between reports
+	slisc::Timer m_timer; // since start()
+	Doub m_last; // time of the last report
+	Int m_ncall; // calls of due() since the last clock reading
+	Long m_nnode_last; // number of nodes at the last report
+
+public:
+	Progress() : m_out(stderr), m_interval(1), m_last(0), m_ncall(0), m_nnode_last(0) {}
+
+	void set(FILE *out, Doub_I interval) { m_out = out; m_interval = interval; }
+
+	// start timing
+	void start(Long_I nnode)
+	{
+		m_timer.tic(); m_last = 0; m_ncall = 0; m_nnode_last = nnode;
+	}
+
+	// if a report is due, the clock is only read every 256 calls
+	Bool due()
+	{
+		if (!m_out || ++m_ncall < 256)
+			return false;
+		m_ncall = 0;
+		return m_timer.toc() - m_last >= m_interval;
+	}
+
+	// write a report
+	// 'depth': depth of the current node, 'Nko_link': number of unresolved ko links
+	// 'root_done' of 'root_total' moves of the root are finished, for a rough ETA (-1 if unknown)
+	void report(Long_I nnode, Long_I npool, Long_I depth, Long_I Nko_link, Int_I root_done, Int_I root_total)
+	{
+		Doub t = m_timer.toc(), eta = -1;
+		if (root_done > 0 && root_total >= root_done)
+			eta = t * (root_total - root_done) / root_done;
+		fprintf(m_out, "{\"time\": %.1f, \"nodes\": %lld, \"nodes_per_sec\": %.1f, \"pool\": %lld, \"depth\": %lld, "
+			"\"ko_links\": %lld, \"root_done\": %d, \"root_total\": %d, \"eta\": %.1f}\n",
+			t, (long long)nnode, (nnode - m_nnode_last) / MAX(t - m_last, 1e-9), (long long)npool,
+			(long long)depth, (long long)Nko_link, root_done, root_total, eta);
+		fflush(m_out);
+		m_last = t; m_nnode_last = nnode;
+	}
+};
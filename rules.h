@@ -0,0 +1,212 @@
+#pragma once
+#include "bitboard.h"
+#include <atomic>
+
+// mutual life is not checked yet, warn once per process instead of every call
+inline void warn_mutual_life()
+{
+	static std::atomic<Bool> warned(false);
+	if (!warned.exchange(true))
+		cout << "warning: check mutual life for large board, ignore for now" << endl;
+}
+
+// rule kernels on bitboards, specialised on board geometry G (BitGeomR or BitGeomT<Nx, Ny>)
+// "mine" are the stones of the player to move, "theirs" are the opponent's
+// see Config for the meaning of each function
+template <class G>
+class Rules
+{
+public:
+	static Int check(Bits_I mine, Bits_I theirs, Int_I ind)
+	{
+		Bits b = Bits(1) << ind, adj, g, dead = 0;
+
+		// check if already occupied
+		if ((mine | theirs) & b)
+			return -1;
+
+		// empty points after placing
+		Bits emp = G::board() & ~(mine | theirs | b);
+
+		// search opponent's dead stones
+		// only necessary if placed next to opposite stone
+		adj = nbr<G>(b) & theirs;
+		while (adj) {
+			g = flood<G>(lowbit(adj), theirs);
+			adj &= ~g;
+			if (!(nbr<G>(g) & emp))
+				dead |= g;
+		}
+
+		if (dead)
+			return popcount(dead);
+
+		// check qi assuming stone is placed
+		if (!(nbr<G>(flood<G>(b, mine | b)) & emp))
+			return -2;
+
+		return 0;
+	}
+
+	// output "dead": removed stones
+	static Int place(Bits_IO mine, Bits_IO theirs, Bits_O dead, Int_I ind)
+	{
+		Bits b = Bits(1) << ind, adj, g;
+		dead = 0;
+
+		// check if already occupied
+		if ((mine | theirs) & b)
+			return -1;
+
+		// place stone
+		mine |= b;
+		Bits emp = G::board() & ~(mine | theirs);
+
+		// remove opponent's dead stones
+		// only necessary if placed next to opposite stone
+		adj = nbr<G>(b) & theirs;
+		while (adj) {
+			g = flood<G>(lowbit(adj), theirs);
+			adj &= ~g;
+			if (!(nbr<G>(g) & emp))
+				dead |= g;
+		}
+
+		if (dead) {
+			theirs &= ~dead;
+			return 0;
+		}
+
+		// check qi of placed stone
+		if (!(nbr<G>(flood<G>(b, mine)) & emp)) {
+			mine &= ~b; // undo placing
+			return -2;
+		}
+
+		return 0;
+	}
+
+	static Bool is_dumb_eye_filling(Bits_I mine, Bits_I theirs, Int_I ind)
+	{
+		Bits b = Bits(1) << ind, emp = G::board() & ~(mine | theirs), adj, g;
+
+		// not my eye
+		if (!(emp & surrounded<G>(mine) & b))
+			return false;
+
+		// check qi of sourrounding groups
+		// if only 1 qi, it's not dumb
+		for (adj = nbr<G>(b); adj; adj &= ~g) {
+			g = flood<G>(lowbit(adj), mine);
+			if (popcount(nbr<G>(g) & emp) == 1)
+				return false;
+		}
+
+		// it is dumb...
+		return true;
+	}
+
+	static Bool is_dumb_2eye_filling(Bits_I mine, Bits_I theirs, Int_I ind)
+	{
+		Bits b = Bits(1) << ind, nb = nbr<G>(b), b_qi, others;
+
+		// all neighbours must be mine except one qi
+		if (nb & theirs) return false; // found opponent stone
+		b_qi = nb & ~mine;
+		if (popcount(b_qi) != 1) return false; // no qi or more than one qi
+
+		// the other qi must also be surrounded by mine (except (x,y))
+		others = (nb | nbr<G>(b_qi)) & ~(b | b_qi);
+		if (!others || (others & ~mine)) return false;
+
+		// all surrounding stones must be connected
+		if (others & ~flood<G>(lowbit(others), mine)) return false;
+
+		// ok, it is dumb...
+		return true;
+	}
+
+	static Bool is_game_end(Bits_I black, Bits_I white)
+	{
+		Bits emp = G::board() & ~(black | white), todo = emp, region;
+		Bits eyes = emp & (surrounded<G>(black) | surrounded<G>(white));
+		Int qi, ind;
+
+		// scan all qi's on the board
+		while (todo) {
+			region = flood<G>(lowbit(todo), emp);
+			todo &= ~region;
+			qi = popcount(region);
+			if (qi > 2)
+				return false;
+			else if (qi == 1) {
+				if (region & eyes)
+					continue;
+				else
+					return false;
+			}
+			else if (qi == 2) {
+				ind = lowbit_ind(region);
+				if (is_dumb_2eye_filling(black, white, ind) || is_dumb_2eye_filling(white, black, ind))
+					return false;
+				warn_mutual_life();
+				return false;
+			}
+		}
+		return true;
+	}
+
+	static Int calc_territory2(Bits_I mine, Bits_I theirs)
+	{
+		Bits emp = G::board() & ~(mine | theirs);
+		// qi surrounded by who
+		Bits qi = emp & surrounded<G>(mine);
+		// qi not surrounded by either side
+		Bits common_qi = emp & ~qi & ~surrounded<G>(theirs);
+		return 2 * (popcount(mine) + popcount(qi)) + popcount(common_qi);
+	}
+};
+
+// rule kernels of one board size
+class RuleTable
+{
+public:
+	Int (*check)(Bits_I mine, Bits_I theirs, Int_I ind);
+	Int (*place)(Bits_IO mine, Bits_IO theirs, Bits_O dead, Int_I ind);
+	Bool (*is_dumb_eye_filling)(Bits_I mine, Bits_I theirs, Int_I ind);
+	Bool (*is_dumb_2eye_filling)(Bits_I mine, Bits_I theirs, Int_I ind);
+	Bool (*is_game_end)(Bits_I black, Bits_I white);
+	Int (*calc_territory2)(Bits_I mine, Bits_I theirs);
+
+	template <class G>
+	void set()
+	{
+		check = Rules<G>::check;
+		place = Rules<G>::place;
+		is_dumb_eye_filling = Rules<G>::is_dumb_eye_filling;
+		is_dumb_2eye_filling = Rules<G>::is_dumb_2eye_filling;
+		is_game_end = Rules<G>::is_game_end;
+		calc_territory2 = Rules<G>::calc_territory2;
+	}
+
+	// use compile-time geometry for square boards 2x2 to 7x7, runtime geometry otherwise
+	RuleTable(Char_I Nx, Char_I Ny)
+	{
+		switch (Nx == Ny ? Nx : 0) {
+		case 2: set<BitGeomT<2, 2>>(); break;
+		case 3: set<BitGeomT<3, 3>>(); break;
+		case 4: set<BitGeomT<4, 4>>(); break;
+		case 5: set<BitGeomT<5, 5>>(); break;
+		case 6: set<BitGeomT<6, 6>>(); break;
+		case 7: set<BitGeomT<7, 7>>(); break;
+		default: set<BitGeomR>();
+		}
+	}
+};
+
+// rule kernels for the board size, chosen on first use (board size must be set before)
+inline const RuleTable & rules()
+{
+	static const RuleTable table(board_Nx(), board_Ny());
+	return table;
+}
@@ -0,0 +1,119 @@
+#pragma once
+#include <atomic>
+#include "move.h"
+
+// bound type of a score stored in TransTable
+enum class Bound : Char { NONE, EXACT, LOWER, UPPER };
+typedef const Bound &Bound_I;
+typedef Bound &Bound_O, &Bound_IO;
+
+// one entry of TransTable (16 bytes)
+// "m_check" is key ^ data, so that an entry torn by a concurrent write fails the check
+// instead of returning data of another key (no lock needed, relaxed atomics only)
+class TransEntry
+{
+public:
+	std::atomic<Ullong> m_check;
+	std::atomic<Ullong> m_data; // see TransTable::pack()
+};
+
+// transposition table for Tree::solve()
+// fixed size, independent of the number of nodes in the tree
+// keyed by the hash of the canonical config and who played (relative to the config)
+// stores bounds of score2 (for who played), the best reply in config coordinates, and the work spent
+// each bucket has a depth-preferred slot (replaced only by more work) and an always-replace slot
+class TransTable
+{
+private:
+	vector<TransEntry> m_entries; // 2 slots per bucket
+	Ullong m_mask; // number of buckets - 1
+
+	static Ullong pack(Int_I score2, Bound_I bound, Move_I best, Long_I work);
+
+public:
+	// Nbucket must be a power of 2
+	TransTable(Long_I Nbucket = 1 << 18);
+
+	// key of a node, who is relative to the config
+	static Ullong key(Ullong_I config_hash, Who_I who_config);
+
+	// find an entry
+	// return true and output the stored data if found
+	Bool probe(Int_O score2, Bound_O bound, Move_O best, Ullong_I key) const;
+
+	// store an entry, "work" (e.g. number of nodes searched) decides replacement
+	void store(Ullong_I key, Int_I score2, Bound_I bound, Move_I best, Long_I work);
+
+	// remove all entries
+	void clear();
+};
+
+inline TransTable::TransTable(Long_I Nbucket) : m_entries(2 * Nbucket), m_mask(Nbucket - 1)
+{
+	if (Nbucket <= 0 || (Nbucket & (Nbucket - 1)))
+		error("TransTable: number of buckets must be a power of 2!");
+	clear();
+}
+
+inline Ullong TransTable::key(Ullong_I config_hash, Who_I who_config)
+{
+	if (who_config == Who::BLACK)
+		return config_hash;
+	else if (who_config == Who::WHITE)
+		return config_hash ^ 0xD6E8FEB86659FD93ULL;
+	error("illegal who!");
+	return 0;
+}
+
+// data layout: score2 (8 bits), bound (8 bits), best x (8 bits), best y (8 bits), work (32 bits)
+// best x is -1 for passing
+inline Ullong TransTable::pack(Int_I score2, Bound_I bound, Move_I best, Long_I work)
+{
+	Ullong w = work < 0xFFFFFFFF ? (Ullong)work : 0xFFFFFFFF;
+	Char x = -1, y = 0;
+	if (best.isplace()) {
+		x = best.x(); y = best.y();
+	}
+	return Ullong(Uchar(score2)) | Ullong(Uchar(bound)) << 8
+		| Ullong(Uchar(x)) << 16 | Ullong(Uchar(y)) << 24 | w << 32;
+}
+
+inline Bool TransTable::probe(Int_O score2, Bound_O bound, Move_O best, Ullong_I key) const
+{
+	const TransEntry *bucket = &m_entries[2 * (key & m_mask)];
+	Ullong data;
+	for (Int i = 0; i < 2; ++i) {
+		data = bucket[i].m_data.load(std::memory_order_relaxed);
+		if ((bucket[i].m_check.load(std::memory_order_relaxed) ^ data) == key && Bound(Char(data >> 8)) != Bound::NONE) {
+			score2 = Uchar(data);
+			bound = Bound(Char(data >> 8));
+			if (Char(data >> 16) < 0)
+				best = Move(Act::PASS);
+			else
+				best = Move(Char(data >> 16), Char(data >> 24));
+			return true;
+		}
+	}
+	return false;
+}
+
+inline void TransTable::store(Ullong_I key, Int_I score2, Bound_I bound, Move_I best, Long_I work)
+{
+	TransEntry *bucket = &m_entries[2 * (key & m_mask)];
+	Ullong data = pack(score2, bound, best, work);
+	Ullong data0 = bucket[0].m_data.load(std::memory_order_relaxed);
+	// depth-preferred slot: same key, or more work than the old entry
+	Int i = (bucket[0].m_check.load(std::memory_order_relaxed) ^ data0) == key || work >= Long(data0 >> 32) ? 0 : 1;
+	// the other slot is always-replace
+	bucket[i].m_data.store(data, std::memory_order_relaxed);
+	bucket[i].m_check.store(key ^ data, std::memory_order_relaxed);
+}
+
+inline void TransTable::clear()
+{
+	// bound NONE
+	for (auto &entry : m_entries) {
+		entry.m_check.store(0, std::memory_order_relaxed);
+		entry.m_data.store(0, std::memory_order_relaxed);
+	}
+}
@@ -1,9 +1,19 @@
 #pragma once
 #include "node.h"
+#include "path_index.h"
+#include "ko_registry.h"
 #include "pool.h"
 #include "boardref.h"
+#include "grouptable.h"
+#include "movegen.h"
+#include "move_order.h"
+#include "progress.h"
+#include "trans_table.h"
 #include "SLISC/search.h"
 #include "SLISC/input.h"
+#include <memory>
+
+using std::shared_ptr;
 
 // game tree
 // a tree index is an index for m_nodes (treeInd), this index should never change for the same node
@@ -12,19 +22,58 @@ class Tree
 {
 private:
 	// === data members ===
-	vector<Node> m_nodes;
+	NodeStore m_nodes;
 	Pool m_pool;
 
-	// unresolved ko links
-	vector<Linkp> m_unreso_ko_links; // debug
+	// unresolved ko links, keyed by Link::key()
+	Registry<Linkp> m_unreso_ko_links; // debug
 
-	// clean ko nodes
-	vector<Long> m_clean_ko_node;
-	vector<Int> m_clean_ko_node_sco2;
-	vector<Sol> m_clean_ko_node_sol;
+	// clean ko nodes, keyed by treeInd
+	Registry<CleanKoNode> m_clean_ko_nodes;
 
 	// links
-	vector<Link> m_links;
+	LinkArena m_links;
+
+	// solved results, kept across solve() calls, can be shared with other trees by share_trans_table()
+	shared_ptr<TransTable> m_trans_table;
+	Long m_tt_probes, m_tt_hits; // calls of trans_table_solve(), and nodes solved by it
+
+	// nodes on the path of solve()
+	PathIndex m_path;
+
+	// history and killer moves of solve()
+	MoveOrder m_order;
+
+	// depth + 1 of the nodes on the path of score_search(), 0 if not on path, indexed by treeInd
+	vector<Int> m_search_path;
+
+	// bounds found by score_search() (score2 of the player to move), created on first use
+	// not shared with solve(), a repeated situation is scored differently
+	// a node reached by passing has its own key (passing again ends the game or is not allowed)
+	shared_ptr<TransTable> m_score_table;
+
+	// number of repeated situations found by score_search(), stored results might depend on them
+	Long m_search_repeat;
+
+	// calls of score_search0(), and the limit (-1 for none, see set_search_max())
+	Long m_search_ncall, m_search_max;
+
+	// solve() prompts the user
+	Bool m_interactive;
+
+	// output of solve()
+	Log m_log;
+	Progress m_progress;
+	Int m_root_done, m_root_total; // moves of the top node of solve() finished, and all moves
+
+	// periodic checkpoints of solve(), empty name for none
+	string m_ckpt_name;
+	Doub m_ckpt_interval; // seconds
+	slisc::Timer m_ckpt_timer; // since the last checkpoint
+	Int m_ckpt_ncall; // calls of checkpoint_due() since the last clock reading
+
+	// a tree using an existing transposition table, for the trees of solve_split()
+	Tree(shared_ptr<TransTable> trans_table);
 
 public:
 	// input
@@ -44,6 +93,24 @@ public:
 
 	Long max_treeInd() const { return m_nodes.size() - 1; }; // maximum treeInd
 
+	Long npool() const { return m_pool.size(); } // number of configurations in the Pool
+
+	Long nlink() const { return m_links.size(); } // number of links in use
+
+	Long tt_probes() const { return m_tt_probes; } // nodes probed in m_trans_table by solve()
+
+	Long tt_hits() const { return m_tt_hits; } // nodes solved from m_trans_table by solve()
+
+	// if solve() prompts the user (default true)
+	// otherwise solve() chooses all moves itself
+	void set_interactive(Bool_I interactive) { m_interactive = interactive; }
+
+	// output of solve() (default Log::NODE), progress lines are written to 'out' every 'interval' seconds
+	void set_log(Log_I log, FILE *out = stderr, Doub_I interval = 1)
+	{
+		m_log = log; m_progress.set(out, interval);
+	}
+
 	void disp_board(Long_I treeInd) const; // display board
 
 	BoardRef get_board(Long_I treeInd) const; // return the board
@@ -53,18 +120,18 @@ public:
 	// return a pointer of a parent link
 	Linkp last(Long_I treeInd, Int_I forkInd = 0) const;
 
-	// return a reference of the last node of a node
-	const Node & lastNode(Long_I treeInd, Int_I forkInd = 0) const;
+	// return the last node of a node
+	const Node lastNode(Long_I treeInd, Int_I forkInd = 0) const;
 
 	// return a pointer of a child link
 	Linkp next(Long_I treeInd, Int_I forkInd = 0) const;
 
-	// return a reference of the next node of a node
+	// return the next node of a node
 	// forkInd can be negative
-	const Node & nextNode(Long_I treeInd, Int_I forkInd = 0) const;
+	const Node nextNode(Long_I treeInd, Int_I forkInd = 0) const;
 
-	// return a reference of the next node of a node
-	Node & nextNode(Long_I treeInd, Int_I forkInd = 0);
+	// return the next node of a node
+	Node nextNode(Long_I treeInd, Int_I forkInd = 0);
 
 	// check if the next node have this move already
 	Bool nextMove_exist(Move mov, Long_I treeInd) const;
@@ -78,9 +145,12 @@ public:
 	// will check if trans is identity and create simple (ko) link if possible
 	void link(LnType_I type, Long_I treeInd_from, Long_I treeInd_to, Move_I move, Trans_I trans);
 
-	// unlink two nodes
+	// unlink two nodes, the link can be used again by relink()
 	Linkp unlink(Long_I treeInd_from, Int_I forkInd);
 
+	// unlink two nodes and free the link for reuse
+	void erase_link(Long_I treeInd_from, Int_I forkInd);
+
 	// relink to nodes
 	void relink(Linkp_I plink);
 
@@ -93,10 +163,10 @@ public:
 	// return 3 if not linked through path, output the merge link to path
 	inline Int islinked(Linkp_O merge_link, Long_I treeInd_from, Long_I treeInd_to);
 
-	// internal recursive function called by islinked()
-	// returns and outputs are the same as islinked0, except
-	// return 4 if linked through non-current branch, merge node not known yet
-	inline Int islinked0(vector<Long> &clean, Linkp_O merge_link, Long_I treeInd_from, Long_I treeInd_to, Bool_I in_curent_branch);
+	// called by islinked(), search the ancestors off the path of each parent of an upward fork
+	// return true and output the merge link (a parent link of treeInd_fork) if treeInd_from is found
+	// the nodes already searched since PathIndex::new_search() are skipped
+	inline Bool islinked0(Linkp_O merge_link, Long_I treeInd_from, Long_I treeInd_fork);
 	
 	// ======== ko related methods =======================
 
@@ -108,6 +178,7 @@ public:
 	// and deal with it
 	// 'nodes[treeInd]' will produce 'config' in the next move
 	// if board already exists, output tree index of the same board
+	// otherwise add the config to the Pool, create the child node and output its tree index
 	// return 0 if this is a new configuration
 	// return -1 if situation exists but not a ko
 	// return -2 if situation exists on path and is a ko
@@ -116,9 +187,19 @@ public:
 	MovRet check_ko(Long_O child_treeInd,
 		Long_I treeInd, Config_I config, Trans_I trans, Move_I move);
 
+	// the child of a node by a move (in the board of the node), created if not exist
+	// return -1 if the move is illegal or ended the game
+	Long child(Long_I treeInd, Move_I move);
+
+	// get an existing child, and shift its ko link if it is no longer linked to path
+	// return MovRet::NEW_ND for a normal child, or a ko link to a node no longer upstream (converted to a normal link)
+	// return MovRet::ON_PA_KO_LN if the child is on path (ko, or a normal link to a node now on path)
+	// return MovRet::OFF_PA_KO_LN if the ko link is shifted to another parent of the child
+	MovRet existing_child(Long_O child_treeInd, Long_I treeInd, Int_I forkInd);
+
 	// find all downstream ko links of a node through ko children
-	// this is a recursive function
-	void ko_links(vector<Linkp> & pLinks, Long_I treeInd) const;
+	// each ko child is searched once, even if ko children link to each other
+	void ko_links(vector<Linkp> & pLinks, Long_I treeInd);
 
 	// push a clean ko node to record
 	void push_clean_ko_node(Long_I treeInd1);
@@ -135,7 +216,7 @@ public:
 
 	// if the node is a clean ko node
 	// return -1 if not clean
-	// return index to m_clean_ko_node[] if clean
+	// return index to m_clean_ko_nodes[] if clean
 	Int check_clean_ko_node(Long_I treeInd) const;
 
 	// get the score of a clean ko node
@@ -150,6 +231,10 @@ public:
 	// pass a turn
 	MovRet pass(Long_O child_treeInd, Long_I treeInd);
 
+	// if "from" is the node before treeInd on the path of solve() or score_search()
+	// true if treeInd is the top or not on a path
+	Bool path_prev(Long_I from, Long_I treeInd) const;
+
 	// check if a placing is legal, or how many stones will be dead
 	// same check already exists for place()
 	// Ko is not considered!
@@ -165,6 +250,14 @@ public:
 	// will not do a dumb move (dumb eye filling or dumb big eye filling)
 	MovRet rand_smart_move(Long_O child_treeInd, Long_I treeInd);
 
+	// same as rand_smart_move(), but takes moves from a generator kept by the caller
+	// the generator is filled on the first call for the node, ordered by m_order
+	// depth: depth of the node on the path for killer moves, -1 if not used
+	MovRet next_move(Long_O child_treeInd, Long_I treeInd, MoveGen &gen, Int_I depth = -1);
+
+	// choose the move ordering of next_move(), and clear the tables
+	void set_order(Order_I order);
+
 	// prompt user for a move
 	// returns are the same as auto_smart_move()
 	MovRet prompt_move(Long_O child_treeInd, Long_I treeInd);
@@ -226,13 +319,29 @@ public:
 	// return the number of unresolved links
 	Int resolve_ko(Long_I treeInd_to);
 
-	// try to resolve a ko link
-	// do nothing if it's already resolved
-	// return the number of unresolved links
-	void resolve_ko_record(Long_I treeInd_from, Long_I treeInd_to);
+	// remove a ko link from m_unreso_ko_links
+	// do nothing if it's not there
+	void resolve_ko_record(Linkp_I plink);
 
 	void solve_end(Long_I treeInd); // solve a bottom node
 
+	// key of a node for m_trans_table
+	Ullong trans_table_key(Long_I treeInd) const;
+
+	// save a bound of score2 (for who played) of a node to m_trans_table
+	// "best" is the best reply in the board of the node, "work" is the number of nodes created
+	void trans_table_store(Long_I treeInd, Int_I score2, Bound_I bound, Move_I best, Long_I work);
+
+	// try to solve an unsolved node from m_trans_table
+	// return true if solved
+	Bool trans_table_solve(Long_I treeInd);
+
+	// use the transposition table of another tree
+	// a Tree never creates two nodes of one situation, so solve() only finds results of other trees,
+	// e.g. when solving several start positions or komis of a board one after another
+	// solve() only probes the table while it's shared (tt_probes() is 0 otherwise)
+	void share_trans_table(const Tree &tree);
+
 	// analyse who has winning strategy for a node
 	// might m_treeInd be changed? it shouldn't
 	// this is a recursive function
@@ -245,6 +354,74 @@ public:
 	// return 3 if is a forbidden node
 	Int solve(Long_I treeInd);
 
+	// solve by root splitting on Nthread threads (tree_split.inl), 'moves' lead from the empty board to treeInd
+	// each child of treeInd is solved by solve() in a new tree sharing m_trans_table, only treeInd and its children
+	// get the results here, solve() is used instead if a child is decided by a ko
+	// return the same as solve()
+	Int solve_split(Long_I treeInd, const vector<Move> &moves, Int_I Nthread);
+
+	// ======== checkpoint (tree_ckpt.inl) ============
+
+	// write the tree to a binary file: nodes, links, Pool and ko registries
+	// m_trans_table and move ordering are not saved, they only speed up the search
+	// a checkpoint written during solve() has the nodes of the path unsolved, solve() again to continue
+	void checkpoint(const string &name);
+
+	// replace the tree by a checkpoint, board size and komi must be the same as the checkpoint
+	// (see checkpoint_header())
+	void restore(const string &name);
+
+	// return an error message if restore() can't read a checkpoint with this header, or nullptr
+	static const char *restore_invalid(const CkptHeader &header);
+
+	// solve() writes a checkpoint every 'interval' seconds, and when requested by install_checkpoint_signals()
+	void set_checkpoint(const string &name, Doub_I interval);
+
+	// called by solve(), write a checkpoint if it is time or requested by a signal
+	// exit after the checkpoint for SIGINT
+	void checkpoint_check();
+
+	// ======== score search (tree_score.inl) ============
+
+	// alpha-beta search of the score2 of the player to move (fail-soft)
+	// uses the same move generation as solve()
+	// repeating a situation on path is not allowed (positional super ko, not the ko rules of solve())
+	// results are saved to m_score_table (not to the nodes), except those that depend on a node above (see score_search0())
+	// return -1 if there is no legal move, -2 if the limit of set_search_max() is reached
+	Int score_search(Long_I treeInd, Int_I alpha, Int_I beta);
+
+	// recursive part of score_search(), "depth" is the depth of treeInd on the search path
+	// "passed" if treeInd is reached by passing
+	// "dep" is set to the smallest depth of a node on path the result depends on (depth + 1 for none)
+	Int score_search0(Long_I treeInd, Int_I alpha0, Int_I beta, Int_I depth, Bool_I passed, Int_O dep);
+
+	// number of repeated situations found by score_search() so far, if 0, no result depends on a ko
+	Long score_search_repeat() const { return m_search_repeat; }
+
+	// exact score2 of the player to move, by MTD(f) (null window searches starting from "guess")
+	// return -1 if there is no legal move, -2 if the limit of set_search_max() is reached
+	Int mtdf(Long_I treeInd, Int_I guess);
+
+	// solution for the player to move with the current komi, by at most two null window searches
+	// return Sol::FORBIDDEN if there is no legal move, Sol::UNKNOWN if the limit of set_search_max() is reached
+	Sol solve_komi(Long_I treeInd);
+
+	// stop score_search() after "n" more calls of score_search0(), -1 for no limit
+	// repeated situations can make the search exponential (e.g. 3x3 from the empty board)
+	void set_search_max(Long_I n) { m_search_ncall = 0; m_search_max = n; }
+
+	// probe m_score_table for score_search()
+	// return true if "g" can be returned for the window
+	// "hint" is the stored best move (Act::INIT if not found)
+	Bool score_search_probe(Int_O g, Move_O hint, Long_I treeInd, Bool_I passed, Int_I alpha, Int_I beta);
+
+	// save the result of score_search() to m_score_table
+	// if "hint", the result depends on the path, only save the best move
+	void score_search_save(Long_I treeInd, Bool_I passed, Int_I alpha0, Int_I beta, Int_I best, Move_I best_move, Long_I work, Bool_I hint);
+
+	// key of m_score_table
+	Ullong score_search_key(Long_I treeInd, Bool_I passed) const;
+
 	~Tree() {}
 };
 
@@ -255,9 +432,7 @@ Who Tree::who(Long_I treeInd) const // who played the node
 
 BoardRef Tree::get_board(Long_I treeInd) const
 {
-	const Config & config = m_pool(m_nodes[treeInd].poolInd());
-	const Trans & trans = m_nodes[treeInd].trans();
-	BoardRef board_ref(config, trans);
+	BoardRef board_ref(m_pool(m_nodes[treeInd].poolInd()), m_nodes[treeInd].trans());
 	return board_ref;
 }
 
@@ -267,12 +442,19 @@ inline Int Tree::nlast(Long_I treeInd) const
 }
 
 // create 0-th node: empty board
-Tree::Tree()
+Tree::Tree() : Tree(std::make_shared<TransTable>()) {}
+
+Tree::Tree(shared_ptr<TransTable> trans_table) : m_trans_table(trans_table), m_tt_probes(0), m_tt_hits(0), m_search_repeat(0),
+	m_search_ncall(0), m_search_max(-1), m_interactive(true),
+	m_log(Log::NODE), m_root_done(0), m_root_total(-1), m_ckpt_interval(0), m_ckpt_ncall(0)
 {
 	inp.openfile("inp.txt");
 	Board board; board.init();
-	m_pool.push(board.config(), board.trans().flip(), -3, 0, Who::NONE, 0);
-	m_nodes.emplace_back(); m_nodes.back().init();
+	// 0-th node is linked as played by both black and white
+	Long poolInd;
+	m_pool.insert(poolInd, board.config());
+	m_pool.link(poolInd, Who::BLACK, 0); m_pool.link(poolInd, Who::WHITE, 0);
+	m_nodes.emplace_back(); m_nodes.back().init(m_links.alloc());
 }
 
 inline Bool Tree::isend(Long_I treeInd) const
@@ -287,7 +469,7 @@ inline Linkp Tree::last(Long_I treeInd, Int_I forkInd) const
 	return m_nodes[treeInd].last(forkInd);
 }
 
-const Node & Tree::lastNode(Long_I treeInd, Int_I forkInd) const // return a reference of the last node of a node
+const Node Tree::lastNode(Long_I treeInd, Int_I forkInd) const // return the last node of a node
 {
 	return m_nodes[last(treeInd, forkInd)->from()];
 }
@@ -297,12 +479,12 @@ inline Linkp Tree::next(Long_I treeInd, Int_I forkInd) const
 	return m_nodes[treeInd].next(forkInd);
 }
 
-inline const Node & Tree::nextNode(Long_I treeInd, Int_I forkInd) const
+inline const Node Tree::nextNode(Long_I treeInd, Int_I forkInd) const
 {
 	return m_nodes[next(treeInd, forkInd)->to()];
 }
 
-Node & Tree::nextNode(Long_I treeInd, Int_I forkInd) // return a reference of the next node of a node
+Node Tree::nextNode(Long_I treeInd, Int_I forkInd) // return the next node of a node
 {
 	return m_nodes[next(treeInd, forkInd)->to()];
 }
@@ -352,11 +534,12 @@ inline MovRet Tree::pass(Long_O child_treeInd, Long_I treeInd)
 	Int i;
 	Long ko_treeInd;
 	BoardRef board = get_board(treeInd);
-	Node & node = m_nodes[treeInd];
+	Node node = m_nodes[treeInd];
 
 	// check double pass
+	// only the parent on path counts, another parent might have passed to this node on another path
 	for (i = 0; i < node.nlast(); ++i) {
-		if (node.last(i)->move().ispass()) {
+		if (node.last(i)->move().ispass() && path_prev(node.last(i)->from(), treeInd)) {
 			// double passed!
 			if (board.is_game_end()) {
 				// two situations have the same scores and solutions!
@@ -378,23 +561,32 @@ inline MovRet Tree::pass(Long_O child_treeInd, Long_I treeInd)
 	}
 
 	// check ko
-	Int search_ret;
-	Long orderInd, treeInd_found;
 	MovRet ret = check_ko(child_treeInd, treeInd, board.config(), board.trans(), Move(Act::PASS));
 
-	if (ret == MovRet::NEW_ND_NEW_CF) { // configuration does not exist
-		error("impossible case, configuration must exist!");
-	}
-	else if (ret == MovRet::NEW_ND_OLD_CF) {
+	// new situation, check_ko() has created the node (a pass keeps the configuration, so it is normally NEW_ND_OLD_CF)
+	if (ret == MovRet::NEW_ND_NEW_CF || ret == MovRet::NEW_ND_OLD_CF) {
 		return MovRet::NEW_ND;
 	}
-	
+
 	return ret;
 }
 
+inline Bool Tree::path_prev(Long_I from, Long_I treeInd) const
+{
+	Int depth;
+	if (m_path.on_path(treeInd)) {
+		depth = m_path.depth(treeInd);
+		return depth == 0 || m_path[depth - 1] == from;
+	}
+	if (treeInd < (Long)m_search_path.size() && m_search_path[treeInd] > 0) {
+		depth = m_search_path[treeInd] - 1;
+		return depth == 0 || (from >= 0 && from < (Long)m_search_path.size() && m_search_path[from] == depth);
+	}
+	return true;
+}
+
 inline Int Tree::check(Char_I x, Char_I y, Long_I treeInd)
 {
-	Int ret;
 	// first move
 	if (treeInd == 0)
 		return 0;
@@ -407,7 +599,6 @@ inline MovRet Tree::place(Long_O child_treeInd, Char_I x, Char_I y, Long_I treeI
 	Board board;
 	board = get_board(treeInd);
 
-	Node & node = m_nodes[treeInd];
 	Who who = Tree::who(treeInd), next_who = ::next(who);
 
 	// update board and check illegal move (Ko no checked!)
@@ -415,21 +606,11 @@ inline MovRet Tree::place(Long_O child_treeInd, Char_I x, Char_I y, Long_I treeI
 		return MovRet::ILLEGAL;
 
 	// check Ko
-	Int search_ret;
-	Long orderInd, treeInd_found;
 	Move move = Move(x, y);
 	MovRet ret = check_ko(child_treeInd, treeInd, board.config(), board.trans(), move);
 
-	// new configuration
-	if (ret == MovRet::NEW_ND_NEW_CF) {
-		m_nodes.emplace_back();
-		Long child_treeInd = max_treeInd();
-		m_pool.push(board.config(), board.trans().flip(), search_ret, orderInd, next_who, child_treeInd);
-		m_nodes.back().set(next_who, m_pool.size() - 1, board.trans());
-		link(LnType::SIMPLE, treeInd, child_treeInd, move);
-		return MovRet::NEW_ND;
-	}
-	else if (ret == MovRet::NEW_ND_OLD_CF) {
+	// new situation
+	if (ret == MovRet::NEW_ND_NEW_CF || ret == MovRet::NEW_ND_OLD_CF) {
 		return MovRet::NEW_ND;
 	}
 
@@ -438,12 +619,12 @@ inline MovRet Tree::place(Long_O child_treeInd, Char_I x, Char_I y, Long_I treeI
 
 inline void Tree::link(LnType_I type, Long_I treeInd_from, Long_I treeInd_to, Move_I move)
 {
-	Linkp plink = Linkp::newlink();
+	Linkp plink = m_links.alloc();
 	plink->link(type, treeInd_from, treeInd_to, move);
 	m_nodes[treeInd_from].push_next(plink);
 	m_nodes[treeInd_to].push_last(plink);
 	if (type == LnType::KO_S)
-		m_unreso_ko_links.push_back(plink); // debug
+		m_unreso_ko_links.insert(plink->key(), plink); // debug
 }
 
 inline void Tree::link(LnType_I type, Long_I treeInd_from, Long_I treeInd_to, Move_I move, Trans_I trans)
@@ -455,172 +636,137 @@ inline void Tree::link(LnType_I type, Long_I treeInd_from, Long_I treeInd_to, Mo
 	}
 
 	// created trans (ko) link
-	Linkp plink = Linkp::newlink();
+	Linkp plink = m_links.alloc();
 	plink->link(type, treeInd_from, treeInd_to, move, trans);
 	m_nodes[treeInd_from].push_next(plink);
 	m_nodes[treeInd_to].push_last(plink);
 	if (type == LnType::KO_T)
-		m_unreso_ko_links.push_back(plink); // debug
+		m_unreso_ko_links.insert(plink->key(), plink); // debug
 }
 
 inline Linkp Tree::unlink(Long_I treeInd_from, Int_I forkInd)
 {
-	Node & node = m_nodes[treeInd_from];
+	Node node = m_nodes[treeInd_from];
 	Linkp plink = node.next(forkInd);
-	Node & next_node = m_nodes[plink->to()];
+	Node next_node = m_nodes[plink->to()];
 	node.delete_next(forkInd);
 	next_node.delete_last(next_node.last_forkInd(plink));
 	return plink;
 }
 
+inline void Tree::erase_link(Long_I treeInd_from, Int_I forkInd)
+{
+	m_links.free(unlink(treeInd_from, forkInd));
+}
+
 inline void Tree::relink(Linkp_I plink)
 {
-	Node & node_from = m_nodes[plink->from()];
-	Node & node_to = m_nodes[plink->to()];
+	Node node_from = m_nodes[plink->from()];
+	Node node_to = m_nodes[plink->to()];
 	node_from.push_next(plink);
 	node_to.push_last(plink);
 }
 
 inline Int Tree::islinked(Linkp_O merge_link, Long_I treeInd_from, Long_I treeInd_to)
 {
-	Int ret;
-	Long i, treeInd;
-	Bool in_current_branch;
+	GOS_PROF_SCOPE(Prof::ISLINKED);
+	Int i;
+	Long treeInd, depth_join;
 	if (treeInd_from == treeInd_to) {
 		return 1;
 	}
-	merge_link = -1; // debug
-
-	static vector<Long> clean; // all searched off path node to be unmarked
-	clean.resize(0);
-	
-	ret = islinked0(clean, merge_link, treeInd_from, treeInd_to, true);
-	
-	// clean marks
-	for (Int j = 0; j < clean.size(); ++j) {
-		m_nodes[clean[j]].mark() = 0;
-	}
-
-	// debug
-	if (ret == 3) {
-		if (merge_link == -1) {
-			error("unknown!");
+	merge_link = Linkp(); // debug
+
+	// on path, linked through path
+	if (m_path.on_path(treeInd_to) && m_path.on_path(treeInd_from)
+		&& m_path.depth(treeInd_from) <= m_path.depth(treeInd_to))
+		return 2;
+
+	// go up from treeInd_to until the current branch joins the path
+	// (a fork not on path ends the current branch)
+	static thread_local vector<Long> branch; // nodes of the current branch off the path
+	branch.resize(0);
+	treeInd = treeInd_to; depth_join = -1;
+	while (true) {
+		if (treeInd == treeInd_from)
+			return 2;
+		if (m_path.on_path(treeInd)) {
+			depth_join = m_path.depth(treeInd);
+			break;
 		}
-	}
-	else if (ret == 4) {
-		error("unknown!");
-	}
-	else {
-		return ret;
-	}
-}
-
-// this is a recursive function
-inline Int Tree::islinked0(vector<Long> &clean, Linkp_O merge_link, Long_I treeInd_from, Long_I treeInd_to, Bool_I in_current_branch)
-{
-	Int ret;
-	Long i, treeInd;
-
-	treeInd = treeInd_to;
-
-	for (i = 0; i < 10000; ++i) {
-		if (treeInd == treeInd_from) {
-			// found it!
-			if (in_current_branch)
-				// linked through current branch
-				return 2;
-			else {
-				// not through current branch
-				// merge node not known
-				return 4;
+		branch.push_back(treeInd);
+		if (m_nodes[treeInd].nlast() > 1) {
+			// upward fork, follow a parent on path if any
+			// (node 0 is a fork after a pass back to the empty board, its init link has no parent, from() is -1)
+			for (i = m_nodes[treeInd].nlast() - 1; i >= 0; --i) {
+				if (!last(treeInd, i)->isko() && !last(treeInd, i)->isinit()
+					&& m_path.on_path(last(treeInd, i)->from()))
+					break;
 			}
+			if (i < 0)
+				break;
+			treeInd = last(treeInd, i)->from();
+		}
+		else if (treeInd == 0) {
+			// reached top of tree
+			break;
 		}
 		else {
-			Char &mark = m_nodes[treeInd].mark();
-			if (!in_current_branch) {
-				// mark searched
-				mark = -1;
-				clean.push_back(treeInd);
-			}
-			if (m_nodes[treeInd].nlast() > 1) {
-				// multiple upward fork
-				break;
-			}
-			else if (treeInd == 0 || mark == -1 || mark == 1 && !in_current_branch) {
-				// 0: reached top of tree
-				// -1: reached searched path
-				// else: path already searched
-				return 0;
-			}
-			else {
-				// single line, go up
-				if (last(treeInd, 0)->isko()) // debug
-					error("lonely parent!");
-				treeInd = last(treeInd, 0)->from();
-			}
+			// single line, go up
+			if (last(treeInd, 0)->isko()) // debug
+				error("lonely parent!");
+			treeInd = last(treeInd, 0)->from();
 		}
 	}
-
-	// at a node with upward fork
-	if (in_current_branch) {
-		// in path, follow path first
-		for (i = m_nodes[treeInd].nlast() - 1; i >= 0; --i) {
-			if (lastNode(treeInd, i).mark() == 1) {
-				ret = islinked0(clean, merge_link, treeInd_from, last(treeInd, i)->from(), true);
-				if (ret == 0) {
-					// not found
-					break;
-				}
-				else if (ret == 2) {
-					// linked through current branch
-					return 2;
-				}
-				else if (ret == 3) {
-					// linked through non-current branch, merge link found
-					return 3;
-				}
-				else {
-					error("unknown!");
-				}
-			}
-		}
+	if (m_path.on_path(treeInd_from) && m_path.depth(treeInd_from) <= depth_join)
+		return 2;
+
+	// linked through a non-current branch, the merge link is a parent link of an upward fork of the current branch
+	// search the forks from the top, so the merge link is the closest to the root
+	m_path.new_search();
+	for (Long d = 0; d <= depth_join; ++d) {
+		if (islinked0(merge_link, treeInd_from, m_path[d]))
+			return 3;
+	}
+	for (Long j = (Long)branch.size() - 1; j >= 0; --j) {
+		if (islinked0(merge_link, treeInd_from, branch[j]))
+			return 3;
 	}
 
-	// treeInd not on path
-	// or not treeInd_from not found on path
-	for (i = m_nodes[treeInd].nlast() - 1; i >= 0; --i) {
-		if (last(treeInd, i)->isko()) {
-			continue; // don't follow ko links
-		}
-		else if (lastNode(treeInd, i).mark() == 1) {
-			continue; // don't follow path (already searched)
-		}
-		else {
-			ret = islinked0(clean, merge_link, treeInd_from, last(treeInd, i)->from(), false);
-			if (ret == 0) {
-				continue; // not found
-			}
-			// linked through non-current branch
-			else if (ret == 4) {
-				// merge link not found
-				if (in_current_branch) {
-					// merge link appears now
-					merge_link = last(treeInd, i);
-					return 3;
-				}
-				else {
-					// merge link still not found
-					return 4;
-				}
+	// not linked
+	return 0;
+}
+
+inline Bool Tree::islinked0(Linkp_O merge_link, Long_I treeInd_from, Long_I treeInd_fork)
+{
+	GOS_PROF_COUNT(Prof::ISLINKED0); // too many calls to time, the time is in islinked()
+	Int i, k;
+	Long treeInd;
+	if (m_nodes[treeInd_fork].nlast() < 2)
+		return false;
+	static thread_local vector<Long> stack;
+	for (i = m_nodes[treeInd_fork].nlast() - 1; i >= 0; --i) {
+		Linkp plink = last(treeInd_fork, i);
+		if (plink->isko() || plink->isinit() || m_path.on_path(plink->from()))
+			continue; // don't follow ko links, the init link of node 0 (from() is -1), or the path
+		// depth first search of the ancestors off the path
+		stack.resize(0);
+		stack.push_back(plink->from());
+		while (!stack.empty()) {
+			treeInd = stack.back(); stack.pop_back();
+			if (treeInd == treeInd_from) {
+				merge_link = plink;
+				return true;
 			}
-			else {
-				error("unknown");
+			if (m_path.on_path(treeInd) || !m_path.visit(treeInd))
+				continue; // path or searched
+			for (k = m_nodes[treeInd].nlast() - 1; k >= 0; --k) {
+				if (!last(treeInd, k)->isko() && !last(treeInd, k)->isinit())
+					stack.push_back(last(treeInd, k)->from());
 			}
 		}
 	}
-
-	// not linked
-	return 0;
+	return false;
 }
 
 inline MovRet Tree::check_ko(Long_O child_treeInd, Long_I treeInd,
@@ -628,59 +774,100 @@ inline MovRet Tree::check_ko(Long_O child_treeInd, Long_I treeInd,
 {
 	Who who = Tree::who(treeInd), next_who = ::next(who);
 	Long poolInd;
-	Long orderInd;
-	Int search_ret = m_pool.search(poolInd, orderInd, config);
-	if (search_ret == 0) {
-		// config already exists
-		if (trans.flip())
-			child_treeInd = m_pool.treeInd(poolInd, who);
-		else
-			child_treeInd = m_pool.treeInd(poolInd, next_who);
-			
-		if (child_treeInd < 0) {
-			// old configuration, new situation
-			m_nodes.emplace_back();
-			child_treeInd = max_treeInd();
-			if (trans.flip())
-				m_pool.link(orderInd, who, child_treeInd);
-			else
-				m_pool.link(orderInd, next_who, child_treeInd);
-			m_nodes.back().set(next_who, m_pool.poolInd(orderInd), trans);
-			link(LnType::SIMPLE, treeInd, child_treeInd, move);
-			return MovRet::NEW_ND_OLD_CF;
-		}
+	// find or add the config
+	Int insert_ret = m_pool.insert(poolInd, config);
+	Who who_config = trans.flip() ? who : next_who;
+	child_treeInd = m_pool.treeInd(poolInd, who_config);
+	if (child_treeInd < 0) {
+		// new situation
+		m_nodes.emplace_back();
+		child_treeInd = max_treeInd();
+		if (m_pool.link(poolInd, who_config, child_treeInd) != child_treeInd)
+			error("situation already exists!");
+		m_nodes.back().set(next_who, poolInd, trans);
+		link(LnType::SIMPLE, treeInd, child_treeInd, move);
+		return insert_ret == 1 ? MovRet::NEW_ND_NEW_CF : MovRet::NEW_ND_OLD_CF;
+	}
+
+	// situation already exists
+	Linkp merge_link;
+	Int ret = islinked(merge_link, child_treeInd, treeInd);
+	if (ret == 1 || ret == 2) {
+		// on path ko link
+		// ret == 1: back to the same node, e.g. a pass from the empty board (node 0 is the situation of both colors)
+		link(LnType::KO_T, treeInd, child_treeInd, move, m_nodes[child_treeInd].trans() - trans);
+		return MovRet::ON_PA_KO_LN;
+	}
+	else if (ret == 3) {
+		// off path ko link
+		link(LnType::TRANS, treeInd, child_treeInd, move, m_nodes[child_treeInd].trans() - trans);
+		merge_link->link_2_ko_link();
+		return MovRet::OFF_PA_KO_LN;
+	}
+	else if (ret == 0) {
+		// situation exists, not a ko
+		link(LnType::TRANS, treeInd, child_treeInd, move, m_nodes[child_treeInd].trans() - trans);
+		return MovRet::LINK;
+	}
+	else
+		error("unknown!");
+	return MovRet::ILLEGAL;
+}
+
+inline Long Tree::child(Long_I treeInd, Move_I move)
+{
+	Int i;
+	Long child_treeInd;
+	MovRet ret;
+	const Node &node = m_nodes[treeInd];
+	for (i = 0; i < node.nnext(); ++i) {
+		if (node.next(i)->move() == move)
+			return node.next(i)->to();
+	}
+	if (move.ispass())
+		ret = pass(child_treeInd, treeInd);
+	else
+		ret = place(child_treeInd, move.x(), move.y(), treeInd);
+	if (ret == MovRet::ILLEGAL || ret == MovRet::DB_PAS_END)
+		return -1;
+	return child_treeInd;
+}
 
-		Linkp merge_link;
-		Int ret = islinked(merge_link, child_treeInd, treeInd);
-		if (ret == 2) {
-			// on path ko link
-			link(LnType::KO_T, treeInd, child_treeInd, move, m_nodes[child_treeInd].trans() - trans);
+inline MovRet Tree::existing_child(Long_O child_treeInd, Long_I treeInd, Int_I forkInd)
+{
+	Linkp plink = m_nodes[treeInd].next(forkInd);
+	child_treeInd = plink->to();
+	if (!plink->isko()) {
+		// a normal link created when the child was not on path, the child can be on the path reached later
+		// through a transposition, then playing the move repeats a situation on path
+		if (m_path.on_path(child_treeInd))
 			return MovRet::ON_PA_KO_LN;
-		}
-		else if (ret == 3) {
-			// off path ko link
-			link(LnType::TRANS, treeInd, child_treeInd, move, m_nodes[child_treeInd].trans() - trans);
-			merge_link->link_2_ko_link();
-			return MovRet::OFF_PA_KO_LN;
-		}
-		else if (ret == 0) {
-			// situation exists, not a ko
-			link(LnType::TRANS, treeInd, child_treeInd, move, m_nodes[child_treeInd].trans() - trans);
-			return MovRet::LINK;
-		}
-		else
-			error("unknown!");
+		return MovRet::NEW_ND;
 	}
-	else {
-		return MovRet::NEW_ND_NEW_CF;
+
+	// existing ko link, check if linked to path
+	Linkp merge_link;
+	Int ret = islinked(merge_link, child_treeInd, treeInd);
+	if (ret == 1 || ret == 2) { // on path ko link
+		return MovRet::ON_PA_KO_LN;
+	}
+	else if (ret == 3) { // off path ko link, shift it
+		plink->ko_link_2_link();
+		merge_link->link_2_ko_link();
+		return MovRet::OFF_PA_KO_LN;
 	}
+	// the ko link was created on another path, its target is no longer upstream (islinked() returns 0),
+	// it is a normal link from here, convert it so that the child keeps a normal parent
+	resolve_ko_record(plink);
+	plink->ko_link_2_link();
+	return MovRet::NEW_ND;
 }
 
 inline void Tree::push_clean_ko_node(Long_I treeInd1)
 {
-	m_clean_ko_node.push_back(treeInd1);
-	m_clean_ko_node_sco2.push_back(score2(treeInd1));
-	m_clean_ko_node_sol.push_back(solution(treeInd1));
+	CleanKoNode rec;
+	rec.m_sco2 = score2(treeInd1); rec.m_sol = solution(treeInd1);
+	m_clean_ko_nodes.insert(treeInd1, rec);
 }
 
 Bool Tree::is_new_clean_ko_node(Long treeInd)
@@ -699,58 +886,56 @@ Bool Tree::is_new_clean_ko_node(Long treeInd)
 	return true;
 }
 
-inline void Tree::ko_links(vector<Linkp> & plinks, Long_I treeInd) const
+inline void Tree::ko_links(vector<Linkp> & plinks, Long_I treeInd)
 {
 	Int i;
 	Long ko_treeInd;
-	const Node & node = m_nodes[treeInd];
-	for (i = 0; i < node.nnext(); ++i) {
-		if (is_ko_child(treeInd, i)) {
-			// found a ko child
-			ko_links(plinks, node.next(i)->to());
-		}
-		else if (node.next(i)->isko()) {
-			// found a ko link
-			plinks.push_back(node.next(i));
+	static thread_local vector<Long> stack;
+	stack.resize(0);
+	stack.push_back(treeInd);
+	m_path.new_search();
+	m_path.visit(treeInd);
+	while (!stack.empty()) {
+		ko_treeInd = stack.back(); stack.pop_back();
+		const Node node = m_nodes[ko_treeInd];
+		for (i = 0; i < node.nnext(); ++i) {
+			if (is_ko_child(ko_treeInd, i)) {
+				// found a ko child
+				if (m_path.visit(node.next(i)->to()))
+					stack.push_back(node.next(i)->to());
+			}
+			else if (node.next(i)->isko()) {
+				// found a ko link
+				plinks.push_back(node.next(i));
+			}
+			// ignoring normal child
 		}
-		// ignoring normal child
 	}
 }
 
 Int Tree::check_clean_ko_node(Long_I treeInd) const
 {
-	Int i, N = m_clean_ko_node.size();
-	for (i = 0; i < N; ++i) {
-		if (m_clean_ko_node[i] == treeInd)
-			return i;
-	}
-	return -1;
+	return m_clean_ko_nodes.find(treeInd);
 }
 
 inline Int Tree::rm_clean_ko_node(Long_I treeInd)
 {
-	Int cleanInd = check_clean_ko_node(treeInd);
-	if (cleanInd >= 0) {
-		m_clean_ko_node.erase(m_clean_ko_node.begin() + cleanInd);
-		m_clean_ko_node_sco2.erase(m_clean_ko_node_sco2.begin() + cleanInd);
-		m_clean_ko_node_sol.erase(m_clean_ko_node_sol.begin() + cleanInd);
-		return 0;
-	}
-	return 1;
+	return m_clean_ko_nodes.remove(treeInd) ? 0 : 1;
 }
 
 Int Tree::clean_ko_node_sco2(Int_I cleanInd) const
 {
-	return m_clean_ko_node_sco2[cleanInd];
+	return m_clean_ko_nodes[cleanInd].m_sco2;
 }
 
 Sol Tree::clean_ko_node_sol(Int_I cleanInd) const
 {
-	return m_clean_ko_node_sol[cleanInd];
+	return m_clean_ko_nodes[cleanInd].m_sol;
 }
 
 inline void Tree::writeSGF(const string &name) const
 {
+	GOS_PROF_SCOPE(Prof::WRITE_SGF);
 	Int i;
 	Char Nx = board_Nx(), Ny = board_Ny();
 	VecBool check(nnode(), false);
@@ -972,14 +1157,7 @@ inline void Tree::writeSGF0_link(ofstream &fout, Long_I treeInd_from, Int_I fork
 
 inline Bool Tree::nextMove_exist(Move mov, Long_I treeInd) const
 {
-	Int i, j;
-	vector<Move> moves;
-	const Node &node = m_nodes[treeInd];
-	for (i = node.nnext() - 1; i >= 0; --i) {
-		if (node.next(i)->move() == mov)
-			return true;
-	}
-	return false;
+	return m_nodes[treeInd].tried(mov);
 }
 
 inline Bool Tree::is_ko_node(Long_I treeInd) const
@@ -1055,62 +1233,54 @@ inline MovRet Tree::prompt_move(Long_O child_treeInd, Long_I treeInd)
 
 inline MovRet Tree::rand_smart_move(Long_O child_treeInd, Long_I treeInd)
 {
-	Bool exist, exist_pass = false;
-	Int i, j, Nx = board_Nx(), Ny = board_Ny(), Nxy = Nx*Ny;
-	MovRet ret;
-	Char x0, y0, x, y;
-	Who who = ::next(Tree::who(treeInd));
-	VecInt xy;
-	Node & node = m_nodes[treeInd];
-	BoardRef board = get_board(treeInd);
-	vector<Move> eat_pos;
+	MoveGen gen;
+	return next_move(child_treeInd, treeInd, gen);
+}
 
-	// consider placing that can eat stones
-	board.eat_list(eat_pos, who);
-	for (i = 0; i < eat_pos.size(); ++i) {
-		x = eat_pos[i].x(); y = eat_pos[i].y();
-		// check existence
-		if (nextMove_exist(Move(x, y), treeInd))
-			continue;
-		// check legal and number of removal
-		ret = place(child_treeInd, x, y, treeInd);
-		if (ret == MovRet::ILLEGAL)
-			continue; // illegal move, no change
-		return ret;
-	}
+inline void Tree::set_order(Order_I order)
+{
+	m_order.set_order(order);
+	m_order.clear();
+}
 
-	// random sequence of all grid points on board
-	randPerm(xy, Nxy);
+inline MovRet Tree::next_move(Long_O child_treeInd, Long_I treeInd, MoveGen &gen, Int_I depth)
+{
+	MovRet ret;
+	Move move;
+	Node node = m_nodes[treeInd];
+
+	// found by an earlier call
+	if (node.all_tried())
+		return MovRet::ALL_EXIST;
+
+	if (!gen.generated()) {
+		Config config;
+		BoardRef board = get_board(treeInd);
+		Who who = ::next(Tree::who(treeInd));
+		board.actual_config(config);
+		if (m_order.order() == Order::HISTORY) {
+			Int score[64];
+			m_order.scores(score, board.trans().flip() ? ::next(who) : who, board.trans(), depth);
+			gen.generate(config, who, score);
+		}
+		else
+			gen.generate(config, who);
+	}
 
-	// search xy for a new legal move (not in Node::m_next)
-	for (i = 0; i < Nxy; ++i) {
-		x = xy[i] % Nx; y = xy[i] / Nx;
+	while (gen.next(move)) {
 		// check existence
-		if (nextMove_exist(Move(x, y), treeInd))
-			continue;
-		// check legal and number of removal
-		if (check(x, y, treeInd) < 0)
+		if (node.tried(move))
 			continue;
-		// check dumb eye filling
-		if (board.is_dumb_eye_filling(x, y, who)) {
-			continue;
-		}
-		if (board.is_dumb_2eye_filling(x, y, who)) {
-			continue;
-		}
-
-		ret = place(child_treeInd, x, y, treeInd);
+		if (move.ispass())
+			return pass(child_treeInd, treeInd);
+		ret = place(child_treeInd, move.x(), move.y(), treeInd);
 		if (ret == MovRet::ILLEGAL)
 			error("impossible!");
 		return ret;
 	}
 
-	// no non-dumb placing left, consider passing
-	if (!nextMove_exist(Move(Act::PASS), treeInd)) {
-		return pass(child_treeInd, treeInd);
-	}
-
 	// all leagl moves already exist
+	node.set_all_tried();
 	return MovRet::ALL_EXIST;
 }
 
@@ -1168,28 +1338,22 @@ inline Int Tree::rand_game(Long_I treeInd0, Bool_I out)
 inline Int Tree::resolve_ko(Long_I treeInd_to)
 {
 	Int i, j, Nko = m_unreso_ko_links.size();
-	Node &node = m_nodes[treeInd_to];
+	Node node = m_nodes[treeInd_to];
 	Linkp plink;
 	for (i = node.nlast() - 1; i >= 0; --i) {
 		plink = node.last(i);
 		if (plink->isko()) {
 			plink->resolve();
-			resolve_ko_record(plink->from(), treeInd_to);
+			resolve_ko_record(plink);
 			--Nko;
 		}
 	}
 	return Nko;
 }
 
-inline void Tree::resolve_ko_record(Long_I treeInd_from, Long_I treeInd_to)
+inline void Tree::resolve_ko_record(Linkp_I plink)
 {
-	for (Int i = m_unreso_ko_links.size() - 1; i >= 0; --i) {
-		if (m_unreso_ko_links[i]->from() == treeInd_from
-			&& m_unreso_ko_links[i]->to() == treeInd_to) {
-			m_unreso_ko_links.erase(m_unreso_ko_links.begin() + i);
-			return;
-		}
-	}
+	m_unreso_ko_links.remove(plink->key());
 }
 
 inline void Tree::solve_end(Long_I treeInd)
@@ -1210,13 +1374,19 @@ Who Tree::winner(Long treeInd) const
 
 void Tree::calc_sol(Long_I treeInd)
 {
-	Sol sol = sco22sol(score2(treeInd), who(treeInd));
+	Who who = Tree::who(treeInd);
+	if (who == Who::NONE)
+		who = Who::WHITE; // empty board, black to play
+	Sol sol = sco22sol(score2(treeInd), who);
 	set_solution(sol, treeInd);
 }
 
 void Tree::calc_ko_sol(Long_I treeInd)
 {
-	Sol sol = sco22sol(score2(treeInd), who(treeInd));
+	Who who = Tree::who(treeInd);
+	if (who == Who::NONE)
+		who = Who::WHITE; // empty board, black to play
+	Sol sol = sco22sol(score2(treeInd), who);
 	set_solution(sol2ko_sol(sol), treeInd);
 }
 
@@ -1288,4 +1458,47 @@ void Tree::calc_score(Long_I treeInd) // calculate territory and save to m_terri
 	set_score2(sco2, treeInd);
 }
 
+inline Ullong Tree::trans_table_key(Long_I treeInd) const
+{
+	return TransTable::key(get_board(treeInd).config().hash(), who_config(treeInd));
+}
+
+inline void Tree::trans_table_store(Long_I treeInd, Int_I score2, Bound_I bound, Move_I best, Long_I work)
+{
+	// store the best reply in config coordinates
+	Move best_config = best;
+	if (best.isplace())
+		inv_transf(best_config.x(), best_config.y(), m_nodes[treeInd].trans().rot());
+	m_trans_table->store(trans_table_key(treeInd), score2, bound, best_config, work);
+}
+
+inline Bool Tree::trans_table_solve(Long_I treeInd)
+{
+	Int sco2;
+	Bound bound;
+	Move best;
+	Sol sol;
+	++m_tt_probes;
+	if (!m_trans_table->probe(sco2, bound, best, trans_table_key(treeInd)))
+		return false;
+	// the solution depends on komi, only use a bound if it decides the solution
+	sol = sco22sol(sco2, who(treeInd));
+	if (bound == Bound::EXACT || (bound == Bound::UPPER && sol == Sol::BAD)
+		|| (bound == Bound::LOWER && sol == Sol::GOOD)) {
+		set_score2(sco2, treeInd);
+		set_solution(sol, treeInd);
+		++m_tt_hits;
+		return true;
+	}
+	return false;
+}
+
+inline void Tree::share_trans_table(const Tree &tree)
+{
+	m_trans_table = tree.m_trans_table;
+}
+
 #include "tree_solve.inl"
+#include "tree_score.inl"
+#include "tree_split.inl"
+#include "tree_ckpt.inl"
@@ -0,0 +1,74 @@
+#pragma once
+#include "tree.h"
+
+inline void Tree::checkpoint(const string &name)
+{
+	CkptHeader header; header.init();
+	header.m_size_next = sizeof(LinkList<4>); header.m_size_last = sizeof(LinkList<2>);
+	header.m_size_link = sizeof(Link);
+	CkptWriter out(name);
+	out.write(header);
+
+	m_links.save(out);
+	m_nodes.save(out, m_links);
+	m_pool.save(out);
+	m_unreso_ko_links.save(out, [this](Linkp_I plink) { return m_links.encode(plink); });
+	m_clean_ko_nodes.save(out, [](const CleanKoNode &rec) { return rec; });
+	out.close();
+}
+
+inline void Tree::restore(const string &name)
+{
+	CkptReader in(name);
+	CkptHeader header;
+	in.read(header);
+	const char *msg = restore_invalid(header);
+	if (msg)
+		error(msg);
+
+	m_links.load(in);
+	m_nodes.load(in, m_links);
+	m_pool.load(in);
+	m_unreso_ko_links.load(in, [this](Linkp_I plink) { return m_links.decode(plink); });
+	m_clean_ko_nodes.load(in, [](const CleanKoNode &rec) { return rec; });
+	m_search_path.clear();
+}
+
+inline const char *Tree::restore_invalid(const CkptHeader &header)
+{
+	const char *msg = header.invalid();
+	if (msg)
+		return msg;
+	if (header.m_Nx != board_Nx() || header.m_Ny != board_Ny() || header.m_komi2 != komi2())
+		return "checkpoint of another board size or komi!";
+	if (header.m_size_next != sizeof(LinkList<4>) || header.m_size_last != sizeof(LinkList<2>)
+		|| header.m_size_link != sizeof(Link))
+		return "checkpoint of another build!";
+	return nullptr;
+}
+
+inline void Tree::set_checkpoint(const string &name, Doub_I interval)
+{
+	m_ckpt_name = name; m_ckpt_interval = interval;
+	m_ckpt_timer.tic(); m_ckpt_ncall = 0;
+}
+
+inline void Tree::checkpoint_check()
+{
+	Int sig = checkpoint_signal().load(std::memory_order_relaxed);
+	if (sig == 0) {
+		// read the clock every 256 calls
+		if (++m_ckpt_ncall < 256)
+			return;
+		m_ckpt_ncall = 0;
+		if (m_ckpt_timer.toc() < m_ckpt_interval)
+			return;
+	}
+	checkpoint_signal().store(0);
+	checkpoint(m_ckpt_name);
+	m_ckpt_timer.tic();
+	if (m_log >= Log::PROGRESS)
+		cout << "checkpoint written: " << m_ckpt_name << " (" << nnode() << " nodes)" << endl;
+	if (sig == 2)
+		std::exit(130); // interrupted
+}
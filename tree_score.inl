@@ -0,0 +1,213 @@
+#pragma once
+#include "tree.h"
+
+// score-bounded search (see "Solution Independent of Komi" in README.md)
+// scores here are score2 of the player to move, unlike Node::score2() which is for who played the node
+// repeating a situation on the search path is not allowed (positional super ko), unlike the ko rules of solve()
+// after a pass, passing again ends the game if Config::is_game_end(), otherwise it is not allowed
+
+inline Ullong Tree::score_search_key(Long_I treeInd, Bool_I passed) const
+{
+	if (passed)
+		return trans_table_key(treeInd) ^ 0x9E3779B97F4A7C15ULL;
+	return trans_table_key(treeInd);
+}
+
+inline Bool Tree::score_search_probe(Int_O g, Move_O hint, Long_I treeInd, Bool_I passed, Int_I alpha, Int_I beta)
+{
+	Bound bound;
+	hint = Move(Act::INIT);
+	if (!m_score_table->probe(g, bound, hint, score_search_key(treeInd, passed)))
+		return false;
+	// the best move in the board of the node
+	if (hint.isplace())
+		transf(hint.x(), hint.y(), m_nodes[treeInd].trans().rot());
+	if (bound == Bound::EXACT)
+		return true;
+	else if (bound == Bound::LOWER && g >= beta)
+		return true;
+	else if (bound == Bound::UPPER && g <= alpha)
+		return true;
+	return false;
+}
+
+inline void Tree::score_search_save(Long_I treeInd, Bool_I passed, Int_I alpha0, Int_I beta, Int_I best, Move_I best_move, Long_I work, Bool_I hint)
+{
+	Int sco2 = best;
+	Bound bound;
+	if (hint) {
+		// only the best move is used, the upper bound of the whole board never cuts a wrong branch
+		sco2 = 2 * board_Nx() * board_Ny();
+		bound = Bound::UPPER;
+	}
+	else if (best <= alpha0)
+		bound = Bound::UPPER;
+	else if (best >= beta)
+		bound = Bound::LOWER;
+	else
+		bound = Bound::EXACT;
+	// store the best move in config coordinates
+	Move best_config = best_move;
+	if (best_move.isplace())
+		inv_transf(best_config.x(), best_config.y(), m_nodes[treeInd].trans().rot());
+	m_score_table->store(score_search_key(treeInd, passed), sco2, bound, best_config, work);
+}
+
+inline Int Tree::score_search(Long_I treeInd, Int_I alpha, Int_I beta)
+{
+	Int dep;
+	if (!m_score_table)
+		m_score_table = std::make_shared<TransTable>();
+	return score_search0(treeInd, alpha, beta, 0, false, dep);
+}
+
+inline Int Tree::score_search0(Long_I treeInd, Int_I alpha0, Int_I beta, Int_I depth, Bool_I passed, Int_O dep)
+{
+	Int i, k, h = -1, g = 0, best = -1, alpha = alpha0, child_dep, Nsco2 = 2 * board_Nx() * board_Ny();
+	Long child_treeInd, nnode0 = nnode();
+	MovRet move_ret = MovRet::ALL_EXIST;
+	Move move, best_move, hint;
+	MoveGen gen; // new children
+
+	dep = depth + 1;
+
+	// out of budget
+	if (m_search_max >= 0 && m_search_ncall >= m_search_max)
+		return -2;
+	++m_search_ncall;
+
+	// bounds from an earlier search
+	if (treeInd > 0 && score_search_probe(g, hint, treeInd, passed, alpha, beta))
+		return g;
+	// otherwise try the best move of an earlier search first
+	for (i = 0; i < m_nodes[treeInd].nnext(); ++i)
+		if (m_nodes[treeInd].next(i)->move() == hint) {
+			h = i; break;
+		}
+
+	// mark path, Node::mark() is not used so that place() and pass() don't do ko bookkeeping for the search path
+	if ((Long)m_search_path.size() < nnode())
+		m_search_path.resize(nnode(), 0);
+	m_search_path[treeInd] = depth + 1;
+
+	// enumerate children, existing ones first (child "h" first)
+	for (k = 0; k < 100000; ++k) {
+		i = h < 0 || k > h ? k : k == 0 ? h : k - 1;
+		if (i >= m_nodes[treeInd].nnext()) {
+			move_ret = next_move(child_treeInd, treeInd, gen);
+			if (move_ret == MovRet::ALL_EXIST)
+				break;
+			if ((Long)m_search_path.size() < nnode())
+				m_search_path.resize(nnode(), 0);
+		}
+
+		if (i >= m_nodes[treeInd].nnext()) {
+			if (move_ret != MovRet::DB_PAS_END)
+				error("unhandled return!");
+			// double pass ended the game
+			g = inv_score2(get_board(treeInd).calc_territory2(who(treeInd)));
+			move = Move(Act::PASS);
+		}
+		else {
+			child_treeInd = m_nodes[treeInd].next(i)->to();
+			move = m_nodes[treeInd].next(i)->move();
+			if (passed && move.ispass()) {
+				// passing back to the parent, only allowed if it ends the game
+				// depends on "passed" (part of the key), not on the path
+				if (!get_board(treeInd).is_game_end())
+					continue;
+				g = inv_score2(get_board(treeInd).calc_territory2(who(treeInd)));
+			}
+			else if (m_search_path[child_treeInd]) {
+				// repeating a situation on path is not allowed
+				dep = MIN(dep, m_search_path[child_treeInd] - 1);
+				++m_search_repeat;
+				continue;
+			}
+			else {
+				g = score_search0(child_treeInd, Nsco2 - beta, Nsco2 - alpha, depth + 1, move.ispass(), child_dep);
+				dep = MIN(dep, child_dep);
+				if (g == -2)
+					break; // out of budget
+				if (g < 0)
+					continue; // child has no legal move
+				g = Nsco2 - g;
+			}
+		}
+
+		if (g > best) {
+			best = g; best_move = move;
+			if (best > alpha)
+				alpha = best;
+		}
+		// beta cut-off, or passing (always the last move) ended the game
+		if (best >= beta || (move.ispass() && i >= m_nodes[treeInd].nnext()))
+			break;
+	}
+
+	m_search_path[treeInd] = 0;
+
+	if (g == -2)
+		return -2;
+	if (best < 0)
+		return -1;
+
+	// save result, unless it depends on a node above (repeated on path)
+	// then only save the best move, if there is no entry
+	if (treeInd > 0 && (dep >= depth || hint.type() == Act::INIT))
+		score_search_save(treeInd, passed, alpha0, beta, best, best_move, nnode() - nnode0, dep < depth);
+	return best;
+}
+
+inline Int Tree::mtdf(Long_I treeInd, Int_I guess)
+{
+	Int g = guess, beta, lower = -1, upper = 2 * board_Nx() * board_Ny();
+	while (lower < upper) {
+		beta = MAX(g, lower + 1);
+		// null window search
+		g = score_search(treeInd, beta - 1, beta);
+		if (g < 0)
+			return g;
+		if (g < beta)
+			upper = g;
+		else
+			lower = g;
+	}
+	return g;
+}
+
+inline Sol Tree::solve_komi(Long_I treeInd)
+{
+	Int g, sco2, good_sco2 = -1, fair_sco2 = -1, Nsco2 = 2 * board_Nx() * board_Ny();
+	Who who = ::next(Tree::who(treeInd));
+
+	// lowest score that is good (or fair) for the player to move
+	for (sco2 = Nsco2; sco2 >= 0; --sco2) {
+		Sol sol = sco22sol(sco2, who);
+		if (sol == Sol::GOOD)
+			good_sco2 = sco2;
+		else if (sol == Sol::FAIR)
+			fair_sco2 = sco2;
+	}
+
+	// null window searches
+	if (good_sco2 >= 0) {
+		g = score_search(treeInd, good_sco2 - 1, good_sco2);
+		if (g == -2)
+			return Sol::UNKNOWN;
+		if (g < 0)
+			return Sol::FORBIDDEN;
+		if (g >= good_sco2)
+			return Sol::GOOD;
+	}
+	if (fair_sco2 >= 0) {
+		g = score_search(treeInd, fair_sco2 - 1, fair_sco2);
+		if (g == -2)
+			return Sol::UNKNOWN;
+		if (g < 0)
+			return Sol::FORBIDDEN;
+		if (g >= fair_sco2)
+			return Sol::FAIR;
+	}
+	return Sol::BAD;
+}
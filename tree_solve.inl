@@ -15,6 +15,11 @@ Int Tree::solve(Long_I treeInd)
 		}
 	}
 
+	// solved in an earlier search of another tree (score in m_trans_table)
+	// a Tree never has two nodes of one situation, so it's only probed when shared
+	if (treeInd > 0 && m_nodes[treeInd].nnext() == 0 && m_trans_table.use_count() > 1 && trans_table_solve(treeInd))
+		return 0;
+
 	Bool debug_stop = nnode() >= 2000; // debug
 	static Bool save = false; // debug
 
@@ -30,45 +35,38 @@ Int Tree::solve(Long_I treeInd)
 	Bool has_ko_link = false, has_ko_child = false;
 	Int best_solvable_child_sco2 = -1;
 	Sol best_solvable_child_sol = Sol::BAD;
+	Move best_move; // move to the best solvable child
+	Long nnode0 = nnode(); // for m_trans_table
 	Int best_ko_child_sco2 = -1;
 	static Long auto_solve_treeInd = 1000000;
+	MoveGen gen; // new children
+	Int depth; // depth on path
 
-	// set mark
-	++m_nodes[treeInd].mark();
+	// add to path
+	if (m_path.empty()) {
+		m_progress.start(nnode());
+		m_root_done = 0; m_root_total = -1;
+	}
+	m_path.push(treeInd);
+	depth = m_path.size() - 1;
 
 	// enumerate children
 	for (i = 0; i < 100000; ++i) {
+		if (m_log >= Log::PROGRESS && m_progress.due())
+			m_progress.report(nnode(), npool(), depth, m_unreso_ko_links.size(), m_root_done, m_root_total);
+		if (!m_ckpt_name.empty())
+			checkpoint_check();
 		// make a move
 		debug_stop = nnode() >= 2000;
 		if (i < m_nodes[treeInd].nnext()) {
 			// check existing child
-			child_treeInd = m_nodes[treeInd].next(i)->to();
-			if (m_nodes[treeInd].next(i)->isko()) {
-				// existing ko link, check if linked to path
-				Linkp merge_link;
-				Int ret = islinked(merge_link, m_nodes[treeInd].next(i)->to(), treeInd);
-				if (ret == 2) { // on path ko link
-					move_ret = MovRet::ON_PA_KO_LN;
-				}
-				else if (ret == 3) { // off path ko link, shift it
-					m_nodes[treeInd].next(i)->ko_link_2_link();
-					merge_link->link_2_ko_link();
-					move_ret = MovRet::OFF_PA_KO_LN;
-				}
-				else {
-					error("unknown!");
-				}
-			}
-			else {
-				// existing child
-				move_ret = MovRet::NEW_ND;
-			}
+			move_ret = existing_child(child_treeInd, treeInd, i);
 		}
 		else {
 			// look for a new child (all existing children checked)
-			// prompt_move() or rand_smart_move
-			if (treeInd >= auto_solve_treeInd) {
-				move_ret = rand_smart_move(child_treeInd, treeInd);
+			// prompt_move() or next_move()
+			if (!m_interactive || treeInd >= auto_solve_treeInd) {
+				move_ret = next_move(child_treeInd, treeInd, gen, depth);
 			}
 			else {
 				if (auto_solve) {
@@ -83,7 +81,7 @@ Int Tree::solve(Long_I treeInd)
 
 				if (auto_solve) {
 					auto_solve_treeInd = treeInd;
-					move_ret = rand_smart_move(child_treeInd, treeInd);
+					move_ret = next_move(child_treeInd, treeInd, gen, depth);
 				}
 				else
 					move_ret = prompt_move(child_treeInd, treeInd);
@@ -91,6 +89,10 @@ Int Tree::solve(Long_I treeInd)
 		}
 
 		// made a move
+		if (depth == 0) {
+			m_root_done = i;
+			m_root_total = MAX(m_nodes[treeInd].nnext(), gen.size());
+		}
 		if (save) { // debug
 			writeSGF("test.sgf");
 			save = false;
@@ -99,10 +101,11 @@ Int Tree::solve(Long_I treeInd)
 		if (move_ret == MovRet::NEW_ND || move_ret == MovRet::LINK
 			|| move_ret == MovRet::OFF_PA_KO_LN) {
 
-			Linkp plink = next(treeInd, -1);
+			// link to the child
+			Linkp plink = i < m_nodes[treeInd].nnext() ? m_nodes[treeInd].next(i) : next(treeInd, -1);
 
 			// debug, display board
-			if (move_ret == MovRet::NEW_ND) {
+			if (m_log == Log::NODE && move_ret == MovRet::NEW_ND) {
 				cout << "largest treeInd = " << max_treeInd() << endl;
 				disp_board(max_treeInd()); cout << "\n\n" << endl;
 				cout << ""; // debug break point
@@ -143,12 +146,12 @@ Int Tree::solve(Long_I treeInd)
 					if (is_new_clean_ko_node(treeInd)) {
 						// is clean ko node
 						push_clean_ko_node(treeInd);
-						--m_nodes[treeInd].mark();
+						m_path.pop();
 						return 2;
 					}
 					else {
 						// not clean ko node
-						--m_nodes[treeInd].mark();
+						m_path.pop();
 						return -1;
 					}
 				}
@@ -161,7 +164,7 @@ Int Tree::solve(Long_I treeInd)
 			}
 			else if (solve_ret == 1) {
 				// double passing solved two nodes
-				--m_nodes[treeInd].mark();
+				m_path.pop();
 				return 0;
 			}
 			else if (solve_ret == 3) {
@@ -183,11 +186,20 @@ Int Tree::solve(Long_I treeInd)
 				if (best_solvable_child_sco2 < child_sco2) {
 					best_solvable_child_sco2 = child_sco2;
 					best_solvable_child_sol = child_sol;
+					best_move = plink->move();
 					if (best_solvable_child_sol == Sol::GOOD) {
+						// a refutation, try it early in other nodes
+						Who who_move = ::next(who(treeInd)); // player to move, relative to the config
+						if (m_nodes[treeInd].trans().flip())
+							who_move = ::next(who_move);
+						m_order.refute(best_move, who_move, m_nodes[treeInd].trans(), depth, 1);
 						set_solution(Sol::BAD, treeInd);
 						set_score2(inv_score2(best_solvable_child_sco2), treeInd);
+						// other children not searched, the score is an upper bound
+						if (treeInd > 0 && !has_ko_link && !has_ko_child)
+							trans_table_store(treeInd, score2(treeInd), Bound::UPPER, best_move, nnode() - nnode0);
 						resolve_ko(treeInd);
-						--m_nodes[treeInd].mark();
+						m_path.pop();
 						return 0;
 					}
 				}
@@ -207,7 +219,7 @@ Int Tree::solve(Long_I treeInd)
 					// all children are forbidden
 					set_solution(Sol::FORBIDDEN, treeInd);
 					resolve_ko(treeInd);
-					--m_nodes[treeInd].mark();
+					m_path.pop();
 					return 3;
 				}
 				// all children solved
@@ -219,8 +231,12 @@ Int Tree::solve(Long_I treeInd)
 					set_solution(Sol::GOOD, treeInd);
 					set_score2(inv_score2(best_solvable_child_sco2), treeInd);
 				}
+				// bad children might only have upper bounds (see below), so a good node only has a lower bound
+				if (treeInd > 0)
+					trans_table_store(treeInd, score2(treeInd), best_solvable_child_sol == Sol::FAIR ? Bound::EXACT : Bound::LOWER,
+						best_move, nnode() - nnode0);
 				resolve_ko(treeInd);
-				--m_nodes[treeInd].mark();
+				m_path.pop();
 				return 0; // debug break point
 			}
 			// not all children solvable
@@ -230,12 +246,12 @@ Int Tree::solve(Long_I treeInd)
 					// forbidden node
 					set_solution(Sol::FORBIDDEN, treeInd);
 					resolve_ko(treeInd);
-					--m_nodes[treeInd].mark();
+					m_path.pop();
 					return 3;
 				}
 				set_score2(inv_score2(best_solvable_child_sco2), treeInd);
 				calc_ko_sol(treeInd);
-				--m_nodes[treeInd].mark();
+				m_path.pop();
 				return -1;
 			}
 			else if (!has_ko_link && has_ko_child) {
@@ -245,7 +261,7 @@ Int Tree::solve(Long_I treeInd)
 					set_score2(inv_score2(best_solvable_child_sco2), treeInd);
 					calc_sol(treeInd);
 					resolve_ko(treeInd);
-					--m_nodes[treeInd].mark();
+					m_path.pop();
 					return 0;
 				}
 				else {
@@ -256,11 +272,11 @@ Int Tree::solve(Long_I treeInd)
 					if (is_new_clean_ko_node(treeInd)) {
 						// is clean ko node
 						push_clean_ko_node(treeInd);
-						--m_nodes[treeInd].mark();
+						m_path.pop();
 						return 2;
 					}
 					else {
-						--m_nodes[treeInd].mark();
+						m_path.pop();
 						return -1;
 					}
 				}
@@ -270,12 +286,12 @@ Int Tree::solve(Long_I treeInd)
 				set_score2(inv_score2(MAX(best_solvable_child_sco2, best_ko_child_sco2)), treeInd);
 				calc_ko_sol(treeInd);
 				resolve_ko(treeInd);
-				--m_nodes[treeInd].mark();
+				m_path.pop();
 				return -1;
 			}
 		}
 		else if (move_ret == MovRet::DB_PAS_END) {
-			--m_nodes[treeInd].mark();
+			m_path.pop();
 			return 1;
 		}
 		else
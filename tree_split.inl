@@ -0,0 +1,121 @@
+#pragma once
+#include "tree.h"
+#include <thread>
+
+// root splitting (see "Parallel Solve" in README.md)
+// each child of the start position is solved by solve() in a new tree, the trees share m_trans_table
+// the first child is solved alone (young brothers wait), so the other children find its results in the table
+
+inline Int Tree::solve_split(Long_I treeInd, const vector<Move> &moves, Int_I Nthread)
+{
+	Int i, n, best_sco2 = -1;
+	Bool has_ko_link = false;
+	Long child_treeInd, ind;
+	MovRet ret;
+	MoveGen gen;
+
+	if (solution(treeInd) != Sol::UNKNOWN || Nthread < 1)
+		return solve(treeInd);
+	// check the moves
+	for (i = 0, ind = 0; i < (Int)moves.size() && ind >= 0; ++i)
+		ind = child(ind, moves[i]);
+	if (ind != treeInd)
+		error("moves don't lead to the node!");
+
+	// children of the start position, a move repeating the path (ko link) is skipped as in solve()
+	vector<Int> todo; // children to solve
+	while ((ret = next_move(child_treeInd, treeInd, gen)) != MovRet::ALL_EXIST) {
+		if (ret == MovRet::ON_PA_KO_LN || ret == MovRet::DB_PAS_KO_LN)
+			has_ko_link = true;
+		else if (ret == MovRet::NEW_ND || ret == MovRet::NEW_ND_NEW_CF || ret == MovRet::NEW_ND_OLD_CF || ret == MovRet::LINK)
+			todo.push_back(m_nodes[treeInd].nnext() - 1);
+		else
+			return solve(treeInd); // the end of the game
+	}
+	n = m_nodes[treeInd].nnext();
+	if (todo.empty())
+		return solve(treeInd);
+
+	// child moves, keys and seeds, read before any thread starts
+	vector<Move> child_moves(n);
+	vector<Ullong> keys(n), seeds(n);
+	for (Int i : todo) {
+		child_moves[i] = m_nodes[treeInd].next(i)->move();
+		keys[i] = trans_table_key(m_nodes[treeInd].next(i)->to());
+		seeds[i] = Ullong(slisc::rand() * 4294967296.) + i;
+	}
+
+	// results of the children, state: 0 not searched, 1 solved, 2 forbidden, 3 decided by a ko
+	vector<Int> sco2(n, -1);
+	vector<Sol> sol(n, Sol::UNKNOWN);
+	vector<Char> state(n, 0);
+	std::atomic<Int> next_todo(1);
+	std::atomic<Bool> cut(false);
+	shared_ptr<TransTable> table = m_trans_table;
+
+	auto work = [&](Int_I i) {
+		Int k, solve_ret;
+		Long ind = 0;
+		Tree tree(table);
+		tree.set_interactive(false);
+		tree.set_log(Log::QUIET);
+		slisc::rand_seed(seeds[i]);
+		for (k = 0; k < (Int)moves.size(); ++k)
+			ind = tree.child(ind, moves[k]);
+		// the start position is on the path, as in solve(treeInd)
+		tree.m_path.push(ind);
+		ind = tree.child(ind, child_moves[i]);
+		if (ind < 0 || tree.trans_table_key(ind) != keys[i]) {
+			state[i] = 3; return;
+		}
+		solve_ret = tree.solve(ind);
+		if (solve_ret == 3)
+			state[i] = 2;
+		else if (solve_ret == 0 && tree.solved(ind)) {
+			sco2[i] = tree.score2(ind); sol[i] = tree.solution(ind);
+			state[i] = 1;
+			if (sol[i] == Sol::GOOD)
+				cut = true; // the start position is lost for who played it
+		}
+		else
+			state[i] = 3;
+	};
+
+	work(todo[0]);
+	if (!cut) {
+		vector<std::thread> threads;
+		for (i = 0; i < MIN(Nthread, (Int)todo.size() - 1); ++i)
+			threads.emplace_back([&]() {
+				Int k;
+				while (!cut && (k = next_todo++) < (Int)todo.size())
+					work(todo[k]);
+			});
+		for (auto &thread : threads)
+			thread.join();
+	}
+
+	// a ko can depend on other children or the nodes above, then solve it in this tree
+	// a good child decides without the ko, as solve() returns before looking at the ko
+	if (!cut) {
+		if (has_ko_link)
+			return solve(treeInd);
+		for (i = 0; i < (Int)todo.size(); ++i)
+			if (state[todo[i]] == 3)
+				return solve(treeInd);
+	}
+
+	for (i = 0; i < n; ++i) {
+		if (state[i] != 1)
+			continue;
+		child_treeInd = m_nodes[treeInd].next(i)->to();
+		set_score2(sco2[i], child_treeInd);
+		set_solution(sol[i], child_treeInd);
+		if (best_sco2 < sco2[i])
+			best_sco2 = sco2[i];
+	}
+	if (best_sco2 < 0)
+		return solve(treeInd); // all children forbidden
+	set_score2(inv_score2(best_sco2), treeInd);
+	calc_sol(treeInd);
+	return 0;
+}